@@ -52,6 +52,10 @@ ifdef FW_PAYLOAD_FDT_ADDR
 firmware-genflags-$(FW_PAYLOAD) += -DFW_PAYLOAD_FDT_ADDR=$(FW_PAYLOAD_FDT_ADDR)
 endif
 
+ifdef FW_PAYLOAD_BENCH
+firmware-genflags-$(FW_PAYLOAD) += -DFW_PAYLOAD_BENCH
+endif
+
 ifdef FW_OPTIONS
 firmware-genflags-y += -DFW_OPTIONS=$(FW_OPTIONS)
 endif
@@ -39,10 +39,284 @@ static inline void sbi_ecall_console_puts(const char *str)
 		__asm__ __volatile__("wfi" ::: "memory"); \
 	} while (0)
 
+#ifdef FW_PAYLOAD_BENCH
+
+#include <sbi/riscv_asm.h>
+
+#define BENCH_MAX_HARTS		8
+#define BENCH_STACK_SIZE	4096
+#define BENCH_ITERATIONS	1000
+
+struct sbiret {
+	long error;
+	long value;
+};
+
+static struct sbiret sbi_ecall(unsigned long ext, unsigned long fid,
+			       unsigned long arg0, unsigned long arg1,
+			       unsigned long arg2, unsigned long arg3)
+{
+	struct sbiret ret;
+	register unsigned long a0 asm("a0") = arg0;
+	register unsigned long a1 asm("a1") = arg1;
+	register unsigned long a2 asm("a2") = arg2;
+	register unsigned long a3 asm("a3") = arg3;
+	register unsigned long a6 asm("a6") = fid;
+	register unsigned long a7 asm("a7") = ext;
+
+	asm volatile("ecall"
+		     : "+r"(a0), "+r"(a1)
+		     : "r"(a2), "r"(a3), "r"(a6), "r"(a7)
+		     : "memory");
+	ret.error = a0;
+	ret.value = a1;
+
+	return ret;
+}
+
+static void bench_put_dec(unsigned long val)
+{
+	char buf[24];
+	int i = 0;
+
+	do {
+		buf[i++] = '0' + (val % 10);
+		val /= 10;
+	} while (val);
+
+	while (i)
+		sbi_ecall_console_putc(buf[--i]);
+}
+
+static void bench_report(const char *name, unsigned long arg,
+			 unsigned long cycles, unsigned long count)
+{
+	sbi_ecall_console_puts("bench: ");
+	sbi_ecall_console_puts(name);
+	if (arg) {
+		sbi_ecall_console_puts(" x");
+		bench_put_dec(arg);
+	}
+	sbi_ecall_console_puts(": ");
+	bench_put_dec(cycles / count);
+	sbi_ecall_console_puts(" cycles/op\n");
+}
+
+/*
+ * Remote fence contention: every secondary HART sends remote SFENCE.VMA
+ * requests to the boot HART, first one sender alone and then all of them
+ * together, so that they contend on the same remote fence queue.
+ */
+static unsigned long bench_stacks[BENCH_MAX_HARTS]
+				 [BENCH_STACK_SIZE / sizeof(unsigned long)];
+static unsigned long bench_cycles[BENCH_MAX_HARTS];
+static unsigned long bench_target;
+static unsigned long bench_senders;
+static unsigned long bench_round;
+static unsigned long bench_started;
+static unsigned long bench_done;
+
+extern void _start_secondary(void);
+
+void test_secondary(unsigned long hartid, unsigned long stack_top)
+{
+	unsigned long i, start, round, seen = 0;
+	unsigned long idx = (stack_top - (unsigned long)bench_stacks) /
+			    BENCH_STACK_SIZE - 1;
+
+	__atomic_fetch_add(&bench_started, 1, __ATOMIC_RELEASE);
+
+	while (1) {
+		do {
+			round = __atomic_load_n(&bench_round, __ATOMIC_ACQUIRE);
+		} while (round == seen);
+		seen = round;
+
+		if (idx < bench_senders) {
+			start = csr_read(CSR_CYCLE);
+			for (i = 0; i < BENCH_ITERATIONS; i++) {
+				/* Far apart ranges so requests are not merged */
+				sbi_ecall(SBI_EXT_RFENCE,
+					  SBI_EXT_RFENCE_REMOTE_SFENCE_VMA,
+					  1, bench_target,
+					  (idx * BENCH_ITERATIONS + i) << 16,
+					  4096);
+			}
+			bench_cycles[idx] = csr_read(CSR_CYCLE) - start;
+		}
+
+		__atomic_fetch_add(&bench_done, 1, __ATOMIC_RELEASE);
+	}
+}
+
+static void bench_rfence_round(unsigned long senders, unsigned long count)
+{
+	unsigned long i, cycles = 0;
+
+	bench_senders = senders;
+	__atomic_store_n(&bench_done, 0, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&bench_round, 1, __ATOMIC_RELEASE);
+
+	/* We are the target so keep taking remote fence IPIs meanwhile */
+	while (__atomic_load_n(&bench_done, __ATOMIC_ACQUIRE) < count)
+		;
+
+	for (i = 0; i < senders; i++)
+		cycles += bench_cycles[i];
+	bench_report("rfence.sfence_vma senders", senders, cycles,
+		     senders * BENCH_ITERATIONS);
+}
+
+static void bench_rfence(unsigned long hartid)
+{
+	struct sbiret ret;
+	unsigned long h, stack_top, count = 0;
+
+	bench_target = hartid;
+	for (h = 0; h < 4 * BENCH_MAX_HARTS && count < BENCH_MAX_HARTS; h++) {
+		if (h == hartid)
+			continue;
+		stack_top = (unsigned long)bench_stacks[count] +
+			    BENCH_STACK_SIZE;
+		ret = sbi_ecall(SBI_EXT_HSM, SBI_EXT_HSM_HART_START, h,
+				(unsigned long)_start_secondary, stack_top, 0);
+		if (!ret.error)
+			count++;
+	}
+
+	if (!count) {
+		sbi_ecall_console_puts("bench: rfence needs more HARTs\n");
+		return;
+	}
+
+	while (__atomic_load_n(&bench_started, __ATOMIC_ACQUIRE) < count)
+		;
+
+	bench_rfence_round(1, count);
+	if (1 < count)
+		bench_rfence_round(count, count);
+}
+
+/*
+ * Ecall dispatch: cheap calls which land on a single extension ID, on an
+ * extension ID range and on no extension at all.
+ */
+static void bench_one_ecall(const char *name, unsigned long ext,
+			    unsigned long fid, unsigned long arg0)
+{
+	unsigned long i, start;
+
+	start = csr_read(CSR_CYCLE);
+	for (i = 0; i < BENCH_ITERATIONS; i++)
+		sbi_ecall(ext, fid, arg0, 0, 0, 0);
+	bench_report(name, 0, csr_read(CSR_CYCLE) - start, BENCH_ITERATIONS);
+}
+
+static void bench_ecall(unsigned long hartid)
+{
+	bench_one_ecall("ecall.base.get_spec_version", SBI_EXT_BASE,
+			SBI_EXT_BASE_GET_SPEC_VERSION, 0);
+	bench_one_ecall("ecall.hsm.get_status", SBI_EXT_HSM,
+			SBI_EXT_HSM_HART_GET_STATUS, hartid);
+	bench_one_ecall("ecall.legacy.clear_ipi", SBI_EXT_0_1_CLEAR_IPI,
+			0, 0);
+	bench_one_ecall("ecall.vendor", SBI_EXT_VENDOR_START, 0, 0);
+	bench_one_ecall("ecall.unknown", 0x0BADBEEF, 0, 0);
+}
+
+/*
+ * Trap classes other than plain ecalls: interrupts taken in M-mode right
+ * after the ecall which raised them, and an illegal instruction which
+ * M-mode fails to emulate and redirects back to our stvec.
+ */
+extern void _bench_skip_trap(void);
+extern void _start_hang(void);
+
+static void bench_trap(unsigned long hartid)
+{
+	unsigned long i, start;
+
+	start = csr_read(CSR_CYCLE);
+	for (i = 0; i < BENCH_ITERATIONS; i++) {
+		sbi_ecall(SBI_EXT_IPI, SBI_EXT_IPI_SEND_IPI, 1, hartid, 0, 0);
+		csr_clear(CSR_SIP, SIP_SSIP);
+	}
+	bench_report("trap.irq.soft (ecall + M-mode IPI)", 0,
+		     csr_read(CSR_CYCLE) - start, BENCH_ITERATIONS);
+
+	start = csr_read(CSR_CYCLE);
+	for (i = 0; i < BENCH_ITERATIONS; i++)
+		sbi_ecall(SBI_EXT_TIME, SBI_EXT_TIME_SET_TIMER, 0, 0, 0, 0);
+	bench_report("trap.irq.timer (ecall + M-mode timer)", 0,
+		     csr_read(CSR_CYCLE) - start, BENCH_ITERATIONS);
+	sbi_ecall(SBI_EXT_TIME, SBI_EXT_TIME_SET_TIMER, -1UL, -1UL, 0, 0);
+
+	csr_write(CSR_STVEC, (unsigned long)_bench_skip_trap);
+	start = csr_read(CSR_CYCLE);
+	for (i = 0; i < BENCH_ITERATIONS; i++)
+		asm volatile(".word 0" ::: "memory");
+	bench_report("trap.illegal_insn (redirected)", 0,
+		     csr_read(CSR_CYCLE) - start, BENCH_ITERATIONS);
+	csr_write(CSR_STVEC, (unsigned long)_start_hang);
+}
+
+/*
+ * Misaligned load/store emulation. Has no effect on HARTs which handle
+ * misaligned accesses in hardware.
+ */
+static unsigned long bench_buf[4];
+
+#define BENCH_MISALIGNED(__name, __insn, __type)			\
+	do {								\
+		unsigned long __i, __start, __val = 0;			\
+		unsigned long __p = (unsigned long)bench_buf + 1;	\
+		__start = csr_read(CSR_CYCLE);				\
+		for (__i = 0; __i < BENCH_ITERATIONS; __i++) {		\
+			if (__type)					\
+				asm volatile(__insn " %0, 0(%1)"	\
+					     : : "r"(__val), "r"(__p)	\
+					     : "memory");		\
+			else						\
+				asm volatile(__insn " %0, 0(%1)"	\
+					     : "=r"(__val) : "r"(__p)	\
+					     : "memory");		\
+		}							\
+		bench_report(__name, 0, csr_read(CSR_CYCLE) - __start,	\
+			     BENCH_ITERATIONS);				\
+	} while (0)
+
+static void bench_misaligned(void)
+{
+	BENCH_MISALIGNED("misaligned.lh", "lh", 0);
+	BENCH_MISALIGNED("misaligned.lw", "lw", 0);
+#if __riscv_xlen == 64
+	BENCH_MISALIGNED("misaligned.ld", "ld", 0);
+#endif
+	BENCH_MISALIGNED("misaligned.sh", "sh", 1);
+	BENCH_MISALIGNED("misaligned.sw", "sw", 1);
+#if __riscv_xlen == 64
+	BENCH_MISALIGNED("misaligned.sd", "sd", 1);
+#endif
+}
+
+static void test_bench(unsigned long hartid)
+{
+	bench_ecall(hartid);
+	bench_trap(hartid);
+	bench_misaligned();
+	bench_rfence(hartid);
+}
+
+#endif
+
 void test_main(unsigned long a0, unsigned long a1)
 {
 	sbi_ecall_console_puts("\nTest payload running\n");
 
+#ifdef FW_PAYLOAD_BENCH
+	test_bench(a0);
+#endif
+
 	while (1)
 		wfi();
 }
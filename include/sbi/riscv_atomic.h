@@ -67,4 +67,20 @@ int atomic_raw_set_bit(int nr, volatile unsigned long *addr);
  */
 int atomic_raw_clear_bit(int nr, volatile unsigned long *addr);
 
+/**
+ * Set a bit in any address and return the whole old value.
+ * @nr : Bit to set.
+ * @addr: Address to modify
+ */
+unsigned long atomic_raw_test_and_set_bit(int nr,
+					  volatile unsigned long *addr);
+
+/**
+ * Clear a bit in any address and return the whole old value.
+ * @nr : Bit to clear.
+ * @addr: Address to modify
+ */
+unsigned long atomic_raw_test_and_clear_bit(int nr,
+					    volatile unsigned long *addr);
+
 #endif
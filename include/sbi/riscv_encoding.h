@@ -76,6 +76,8 @@
 #define HSTATUS_GVA			_UL(0x00000040)
 #define HSTATUS_VSBE			_UL(0x00000020)
 
+#define ENVCFG_STCE			_ULL(0x8000000000000000)
+
 #define IRQ_S_SOFT			1
 #define IRQ_VS_SOFT			2
 #define IRQ_M_SOFT			3
@@ -105,6 +107,10 @@
 #define PRV_S				_UL(1)
 #define PRV_M				_UL(3)
 
+#define MTVEC_MODE			_UL(0x3)
+#define MTVEC_MODE_DIRECT		_UL(0)
+#define MTVEC_MODE_VECTORED		_UL(1)
+
 #define SATP32_MODE			_UL(0x80000000)
 #define SATP32_ASID			_UL(0x7FC00000)
 #define SATP32_PPN			_UL(0x003FFFFF)
@@ -273,6 +279,10 @@
 #define CSR_STVAL			0x143
 #define CSR_SIP				0x144
 
+/* Supervisor Timer Compare (Sstc-extension) */
+#define CSR_STIMECMP			0x14d
+#define CSR_STIMECMPH			0x15d
+
 /* Supervisor Protection and Translation */
 #define CSR_SATP			0x180
 
@@ -329,6 +339,10 @@
 #define CSR_MCOUNTEREN			0x306
 #define CSR_MSTATUSH			0x310
 
+/* Machine Configuration */
+#define CSR_MENVCFG			0x30a
+#define CSR_MENVCFGH			0x31a
+
 /* Machine Trap Handling */
 #define CSR_MSCRATCH			0x340
 #define CSR_MEPC			0x341
@@ -625,6 +639,10 @@
 #define INSN_MASK_WFI			0xffffff00
 #define INSN_MATCH_WFI			0x10500000
 
+#define INSN_MASK_CSRR_TIME		0xfffff07f
+#define INSN_MATCH_CSRR_TIME		0xc0102073
+#define INSN_MATCH_CSRR_TIMEH		0xc8102073
+
 #define INSN_16BIT_MASK			0x3
 #define INSN_32BIT_MASK			0x1c
 
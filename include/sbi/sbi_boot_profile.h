@@ -0,0 +1,79 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#ifndef __SBI_BOOT_PROFILE_H__
+#define __SBI_BOOT_PROFILE_H__
+
+#include <sbi/sbi_types.h>
+
+/* clang-format off */
+
+#define SBI_BOOT_PROFILE_MAX_RECORDS		24
+
+/* clang-format on */
+
+/** Boot stages, each record marks the end of a stage */
+enum sbi_boot_stage {
+	SBI_BOOT_STAGE_ENTRY = 0,
+	SBI_BOOT_STAGE_SCRATCH,
+	SBI_BOOT_STAGE_DOMAIN,
+	SBI_BOOT_STAGE_COLDBOOT_WAIT,
+	SBI_BOOT_STAGE_HSM,
+	SBI_BOOT_STAGE_PLATFORM_EARLY,
+	SBI_BOOT_STAGE_HART,
+	SBI_BOOT_STAGE_CONSOLE,
+	SBI_BOOT_STAGE_IRQCHIP,
+	SBI_BOOT_STAGE_IPI,
+	SBI_BOOT_STAGE_TLB,
+	SBI_BOOT_STAGE_TIMER,
+	SBI_BOOT_STAGE_ECALL,
+	SBI_BOOT_STAGE_DOMAIN_FINALIZE,
+	SBI_BOOT_STAGE_PMP,
+	SBI_BOOT_STAGE_PLATFORM_FINAL,
+	SBI_BOOT_STAGE_BANNER,
+	SBI_BOOT_STAGE_GENERAL_INFO,
+	SBI_BOOT_STAGE_DOMAIN_INFO,
+	SBI_BOOT_STAGE_HART_INFO,
+	SBI_BOOT_STAGE_MAX,
+};
+
+/** One boot profile record (layout is shared with lower privilege) */
+struct sbi_boot_profile_record {
+	/** Boot stage (sbi_boot_stage) which ended */
+	u32 stage;
+	/** Reserved for future use */
+	u32 reserved;
+	/** MCYCLE value of the HART */
+	u64 cycle;
+	/** Timer value (zero if unknown, e.g. before cold boot timer init) */
+	u64 time;
+} __packed;
+
+/** Boot profile of one HART (layout is shared with lower privilege) */
+struct sbi_boot_profile {
+	/** Number of valid records */
+	u32 count;
+	/** Non-zero if this HART did the cold boot */
+	u32 cold_boot;
+	/** Records in the order they were taken */
+	struct sbi_boot_profile_record records[SBI_BOOT_PROFILE_MAX_RECORDS];
+} __packed;
+
+struct sbi_scratch;
+
+u64 sbi_boot_profile_cycle(void);
+
+int sbi_boot_profile_init(struct sbi_scratch *scratch, bool cold_boot,
+			  u64 entry_cycle);
+
+void sbi_boot_profile_mark(struct sbi_scratch *scratch,
+			   enum sbi_boot_stage stage);
+
+const struct sbi_boot_profile *sbi_boot_profile_get(u32 hartid);
+
+const char *sbi_boot_profile_stage_name(u32 stage);
+
+void sbi_boot_profile_dump(struct sbi_scratch *scratch);
+
+#endif
@@ -17,6 +17,17 @@
 #define SBI_ECALL_VERSION_MINOR		2
 #define SBI_OPENSBI_IMPID		1
 
+/*
+ * Extension lookup is constant time for up to SBI_ECALL_MAX_EXTIDS
+ * extensions with a single extension ID and logarithmic for up to
+ * SBI_ECALL_MAX_RANGES extensions covering an extension ID range.
+ * Extensions registered beyond these limits still work but are found
+ * by a linear search which every lookup miss also pays for.
+ */
+#define SBI_ECALL_HASH_BITS		5
+#define SBI_ECALL_MAX_EXTIDS		(1UL << (SBI_ECALL_HASH_BITS - 1))
+#define SBI_ECALL_MAX_RANGES		16
+
 struct sbi_trap_regs;
 struct sbi_trap_info;
 
@@ -39,6 +50,8 @@ extern struct sbi_ecall_extension ecall_ipi;
 extern struct sbi_ecall_extension ecall_vendor;
 extern struct sbi_ecall_extension ecall_hsm;
 extern struct sbi_ecall_extension ecall_srst;
+extern struct sbi_ecall_extension ecall_async_rfence;
+extern struct sbi_ecall_extension ecall_boot_profile;
 
 u16 sbi_ecall_version_major(void);
 
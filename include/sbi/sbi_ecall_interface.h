@@ -29,6 +29,10 @@
 #define SBI_EXT_HSM				0x48534D
 #define SBI_EXT_SRST				0x53525354
 
+/* OpenSBI specific extension IDs (firmware range) */
+#define SBI_EXT_OPENSBI_ASYNC_RFENCE		0x0A415246
+#define SBI_EXT_OPENSBI_BOOT_PROFILE		0x0A425052
+
 /* SBI function IDs for BASE extension*/
 #define SBI_EXT_BASE_GET_SPEC_VERSION		0x0
 #define SBI_EXT_BASE_GET_IMP_ID			0x1
@@ -53,15 +57,42 @@
 #define SBI_EXT_RFENCE_REMOTE_HFENCE_VVMA	0x5
 #define SBI_EXT_RFENCE_REMOTE_HFENCE_VVMA_ASID	0x6
 
+/*
+ * SBI function IDs for OpenSBI ASYNC_RFENCE extension
+ * Note: function IDs 0x0 to 0x6 match the RFENCE extension
+ * Note: TICKET_POLL is a conservative hint which may keep reporting a
+ * ticket as pending while the caller has newer requests outstanding,
+ * only TICKET_WAIT guarantees completion.
+ */
+#define SBI_EXT_ASYNC_RFENCE_TICKET_POLL	0x10
+#define SBI_EXT_ASYNC_RFENCE_TICKET_WAIT	0x11
+
+/* SBI function IDs for OpenSBI BOOT_PROFILE extension */
+#define SBI_EXT_BOOT_PROFILE_GET_SIZE		0x0
+#define SBI_EXT_BOOT_PROFILE_READ		0x1
+#define SBI_EXT_BOOT_PROFILE_RESUME_LATENCY	0x2
+
 /* SBI function IDs for HSM extension */
 #define SBI_EXT_HSM_HART_START			0x0
 #define SBI_EXT_HSM_HART_STOP			0x1
 #define SBI_EXT_HSM_HART_GET_STATUS		0x2
+#define SBI_EXT_HSM_HART_SUSPEND		0x3
 
 #define SBI_HSM_HART_STATUS_STARTED		0x0
 #define SBI_HSM_HART_STATUS_STOPPED		0x1
 #define SBI_HSM_HART_STATUS_START_PENDING	0x2
 #define SBI_HSM_HART_STATUS_STOP_PENDING	0x3
+#define SBI_HSM_HART_STATUS_SUSPENDED		0x4
+#define SBI_HSM_HART_STATUS_SUSPEND_PENDING	0x5
+#define SBI_HSM_HART_STATUS_RESUME_PENDING	0x6
+
+#define SBI_HSM_SUSPEND_RET_DEFAULT		0x00000000
+#define SBI_HSM_SUSPEND_RET_PLATFORM		0x10000000
+#define SBI_HSM_SUSPEND_RET_LAST		0x7FFFFFFF
+#define SBI_HSM_SUSPEND_NON_RET_BIT		0x80000000
+#define SBI_HSM_SUSPEND_NON_RET_DEFAULT		0x80000000
+#define SBI_HSM_SUSPEND_NON_RET_PLATFORM	0x90000000
+#define SBI_HSM_SUSPEND_NON_RET_LAST		0xFFFFFFFF
 
 /* SBI function IDs for SRST extension */
 #define SBI_EXT_SRST_RESET			0x0
@@ -77,6 +108,8 @@
 #define SBI_SPEC_VERSION_MAJOR_OFFSET		24
 #define SBI_SPEC_VERSION_MAJOR_MASK		0x7f
 #define SBI_SPEC_VERSION_MINOR_MASK		0xffffff
+#define SBI_EXT_EXPERIMENTAL_START		0x08000000
+#define SBI_EXT_EXPERIMENTAL_END		0x08FFFFFF
 #define SBI_EXT_VENDOR_START			0x09000000
 #define SBI_EXT_VENDOR_END			0x09FFFFFF
 #define SBI_EXT_FIRMWARE_START			0x0A000000
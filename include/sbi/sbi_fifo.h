@@ -11,6 +11,7 @@
 #ifndef __SBI_FIFO_H__
 #define __SBI_FIFO_H__
 
+#include <sbi/riscv_atomic.h>
 #include <sbi/riscv_locks.h>
 #include <sbi/sbi_types.h>
 
@@ -39,4 +40,38 @@ int sbi_fifo_inplace_update(struct sbi_fifo *fifo, void *in,
 			    int (*fptr)(void *in, void *data));
 u16 sbi_fifo_avail(struct sbi_fifo *fifo);
 
+/**
+ * Lock-free multi-producer/single-consumer variant of sbi_fifo
+ *
+ * Each slot carries a sequence number which tells producers and the
+ * consumer whether the slot is free, published or claimed so that no
+ * queue wide lock is needed. Only one HART (the owner) may dequeue.
+ */
+struct sbi_mpsc_fifo {
+	void *queue;
+	atomic_t head;
+	volatile unsigned long tail;
+	u16 entry_size;
+	u16 slot_size;
+	u16 num_entries;
+};
+
+/** Header placed in front of every sbi_mpsc_fifo entry */
+struct sbi_mpsc_fifo_slot {
+	atomic_t seq;
+};
+
+/** Size of one sbi_mpsc_fifo slot holding an entry of given size */
+#define SBI_MPSC_FIFO_SLOT_SIZE(__entry_size)				\
+	(sizeof(struct sbi_mpsc_fifo_slot) +				\
+	 (((__entry_size) + sizeof(long) - 1) & ~(sizeof(long) - 1)))
+
+int sbi_mpsc_fifo_init(struct sbi_mpsc_fifo *fifo, void *queue_mem,
+		       u16 entries, u16 entry_size);
+int sbi_mpsc_fifo_enqueue(struct sbi_mpsc_fifo *fifo, void *data);
+int sbi_mpsc_fifo_dequeue(struct sbi_mpsc_fifo *fifo, void *data);
+bool sbi_mpsc_fifo_is_empty(struct sbi_mpsc_fifo *fifo);
+int sbi_mpsc_fifo_inplace_update(struct sbi_mpsc_fifo *fifo, void *in,
+				 int (*fptr)(void *in, void *data));
+
 #endif
@@ -11,6 +11,7 @@
 #define __SBI_HART_H__
 
 #include <sbi/sbi_types.h>
+#include <sbi/sbi_scratch.h>
 
 /** Possible feature flags of a hart */
 enum sbi_hart_features {
@@ -20,15 +21,33 @@ enum sbi_hart_features {
 	SBI_HART_HAS_MCOUNTEREN = (1 << 1),
 	/** HART has timer csr implementation in hardware */
 	SBI_HART_HAS_TIME = (1 << 2),
+	/** HART has Svinval fine-grained address translation cache invalidation */
+	SBI_HART_HAS_SVINVAL = (1 << 3),
+	/** HART has supervisor timer compare (Sstc) CSRs */
+	SBI_HART_HAS_SSTC = (1 << 4),
 
 	/** Last index of Hart features*/
-	SBI_HART_HAS_LAST_FEATURE = SBI_HART_HAS_TIME,
+	SBI_HART_HAS_LAST_FEATURE = SBI_HART_HAS_SSTC,
 };
 
-struct sbi_scratch;
-
+int sbi_hart_reinit(struct sbi_scratch *scratch);
 int sbi_hart_init(struct sbi_scratch *scratch, bool cold_boot);
 
+/** Offset of per-HART ISA extension bitmap detected at HART init */
+extern unsigned long hart_isa_offset;
+
+/**
+ * Check a single letter ISA extension ('A' to 'Z') of a HART using the
+ * bitmap cached at HART init instead of reading the MISA CSR
+ */
+static inline bool sbi_hart_has_extension(struct sbi_scratch *scratch,
+					  char ext)
+{
+	unsigned long *isa = sbi_scratch_offset_ptr(scratch, hart_isa_offset);
+
+	return (*isa & (1UL << (ext - 'A'))) ? TRUE : FALSE;
+}
+
 extern void (*sbi_hart_expected_trap)(void);
 static inline ulong sbi_hart_expected_trap_addr(void)
 {
@@ -18,6 +18,9 @@
 #define SBI_HART_STARTING	2
 #define SBI_HART_STARTED	3
 #define SBI_HART_UNKNOWN	4
+#define SBI_HART_SUSPENDING	5
+#define SBI_HART_SUSPENDED	6
+#define SBI_HART_RESUMING	7
 
 struct sbi_domain;
 struct sbi_scratch;
@@ -29,10 +32,18 @@ int sbi_hsm_hart_start(struct sbi_scratch *scratch,
 		       const struct sbi_domain *dom,
 		       u32 hartid, ulong saddr, ulong smode, ulong priv);
 int sbi_hsm_hart_stop(struct sbi_scratch *scratch, bool exitnow);
+int sbi_hsm_hart_suspend(struct sbi_scratch *scratch, u32 suspend_type,
+			 ulong raddr, ulong rmode, ulong priv);
+void sbi_hsm_hart_resume_start(struct sbi_scratch *scratch);
+void sbi_hsm_hart_resume_finish(struct sbi_scratch *scratch);
+void sbi_hsm_hart_resume_latency(struct sbi_scratch *scratch,
+				 u64 *last, u64 *max);
 int sbi_hsm_hart_get_state(const struct sbi_domain *dom, u32 hartid);
 int sbi_hsm_hart_state_to_status(int state);
 int sbi_hsm_hart_started_mask(const struct sbi_domain *dom,
 			      ulong hbase, ulong *out_hmask);
+int sbi_hsm_hart_interruptible_mask(const struct sbi_domain *dom,
+				    ulong hbase, ulong *out_hmask);
 void sbi_hsm_prepare_next_jump(struct sbi_scratch *scratch, u32 hartid);
 
 #endif
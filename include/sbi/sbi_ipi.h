@@ -37,10 +37,18 @@ struct sbi_ipi_event_ops {
 	/**
 	 * Sync callback to wait for remote HART
 	 * Note: This is an optional callback and it is called just after
-	 * triggering IPI to remote HART.
+	 * triggering IPI to each remote HART.
 	 */
 	void (* sync)(struct sbi_scratch *scratch);
 
+	/**
+	 * Sync callback to wait for all remote HARTs together
+	 * Note: This is an optional callback and it is called only once
+	 * after triggering IPI to all remote HARTs. Only events which can
+	 * count acknowledgements from several HARTs should provide it.
+	 */
+	void (* sync_all)(struct sbi_scratch *scratch);
+
 	/**
 	 * Process callback to handle IPI event
 	 * Note: This is a mandatory callback and it is called on the
@@ -61,6 +69,12 @@ void sbi_ipi_clear_smode(void);
 
 int sbi_ipi_send_halt(ulong hmask, ulong hbase);
 
+/** Number of IPI doorbells rung by given HART */
+unsigned long sbi_ipi_doorbell_count(struct sbi_scratch *scratch);
+
+/** Number of IPI doorbells skipped by given HART as the target had one pending */
+unsigned long sbi_ipi_doorbell_suppressed_count(struct sbi_scratch *scratch);
+
 void sbi_ipi_process(void);
 
 int sbi_ipi_init(struct sbi_scratch *scratch, bool cold_boot);
@@ -58,9 +58,13 @@ enum sbi_platform_features {
 	SBI_PLATFORM_HAS_MFAULTS_DELEGATION = (1 << 2),
 	/** Platform has custom secondary hart booting support */
 	SBI_PLATFORM_HAS_HART_SECONDARY_BOOT = (1 << 3),
+	/** Platform has identical HARTs which can share CSR probe results */
+	SBI_PLATFORM_HAS_HOMOGENEOUS_HARTS = (1 << 4),
+	/** Platform wants TLB range flush limit calibrated at boot time */
+	SBI_PLATFORM_HAS_TLB_FLUSH_CALIBRATE = (1 << 5),
 
 	/** Last index of Platform features*/
-	SBI_PLATFORM_HAS_LAST_FEATURE = SBI_PLATFORM_HAS_HART_SECONDARY_BOOT,
+	SBI_PLATFORM_HAS_LAST_FEATURE = SBI_PLATFORM_HAS_TLB_FLUSH_CALIBRATE,
 };
 
 /** Default feature set for a platform */
@@ -106,10 +110,24 @@ struct sbi_platform_operations {
 	/** Exit the platform interrupt controller for current HART */
 	void (*irqchip_exit)(void);
 
-	/** Send IPI to a target HART */
+	/**
+	 * Send IPI to a target HART
+	 * Note: prior memory writes must be visible to the target HART
+	 * before the IPI, e.g. by using writel() for the doorbell
+	 */
 	void (*ipi_send)(u32 target_hart);
+	/**
+	 * Send IPI to all HARTs in a hartmask (optional)
+	 * Note: same ordering requirement as ipi_send()
+	 */
+	void (*ipi_send_mask)(ulong hmask, ulong hbase);
 	/** Clear IPI for a target HART */
 	void (*ipi_clear)(u32 target_hart);
+	/**
+	 * Raise supervisor software interrupt on a target HART without
+	 * going through M-mode on the target (optional)
+	 */
+	int (*ipi_send_smode)(u32 target_hart);
 	/** Initialize IPI for current HART */
 	int (*ipi_init)(bool cold_boot);
 	/** Exit IPI for current HART */
@@ -136,6 +154,11 @@ struct sbi_platform_operations {
 	 * return if success.
 	 */
 	int (*hart_stop)(void);
+	/**
+	 * Put the current hart in a platform specific suspend state. For
+	 * non-retentive types the hart may resume at the warm boot address.
+	 */
+	int (*hart_suspend)(u32 suspend_type, ulong raddr);
 
 	/* Check whether reset type and reason supported by the platform */
 	int (*system_reset_check)(u32 reset_type, u32 reset_reason);
@@ -220,6 +243,12 @@ struct sbi_platform {
 /** Check whether the platform supports custom secondary hart booting support */
 #define sbi_platform_has_hart_secondary_boot(__p) \
 	((__p)->features & SBI_PLATFORM_HAS_HART_SECONDARY_BOOT)
+/** Check whether the platform has identical HARTs */
+#define sbi_platform_has_homogeneous_harts(__p) \
+	((__p)->features & SBI_PLATFORM_HAS_HOMOGENEOUS_HARTS)
+/** Check whether the platform wants TLB range flush limit calibration */
+#define sbi_platform_has_tlb_flush_calibrate(__p) \
+	((__p)->features & SBI_PLATFORM_HAS_TLB_FLUSH_CALIBRATE)
 
 /**
  * Get HART index for the given HART
@@ -367,6 +396,25 @@ static inline int sbi_platform_hart_stop(const struct sbi_platform *plat)
 	return SBI_ENOTSUPP;
 }
 
+/**
+ * Put the current hart in a platform specific suspend state
+ *
+ * @param plat pointer to struct sbi_platform
+ * @param suspend_type platform specific suspend type
+ * @param raddr M-mode resume address for non-retentive suspend types
+ *
+ * @return 0 after wakeup and negative error code on failure. It does not
+ * return on success if the hart lost its state in a non-retentive type.
+ */
+static inline int sbi_platform_hart_suspend(const struct sbi_platform *plat,
+					    u32 suspend_type, ulong raddr)
+{
+	if (plat && sbi_platform_ops(plat)->hart_suspend)
+		return sbi_platform_ops(plat)->hart_suspend(suspend_type,
+							    raddr);
+	return SBI_ENOTSUPP;
+}
+
 /**
  * Early initialization for current HART
  *
@@ -546,6 +594,38 @@ static inline void sbi_platform_ipi_send(const struct sbi_platform *plat,
 		sbi_platform_ops(plat)->ipi_send(target_hart);
 }
 
+/**
+ * Send IPI to all HARTs in a hartmask
+ *
+ * Falls back to one ipi_send() call per HART when the platform does not
+ * provide a batched ipi_send_mask() operation.
+ *
+ * @param plat pointer to struct sbi_platform
+ * @param hmask mask of target HARTs relative to hbase
+ * @param hbase HART ID of bit 0 in hmask
+ */
+static inline void sbi_platform_ipi_send_mask(const struct sbi_platform *plat,
+					      ulong hmask, ulong hbase)
+{
+	ulong i;
+
+	if (!plat)
+		return;
+
+	if (sbi_platform_ops(plat)->ipi_send_mask) {
+		sbi_platform_ops(plat)->ipi_send_mask(hmask, hbase);
+		return;
+	}
+
+	if (!sbi_platform_ops(plat)->ipi_send)
+		return;
+
+	for (i = hbase; hmask; i++, hmask >>= 1) {
+		if (hmask & 1UL)
+			sbi_platform_ops(plat)->ipi_send(i);
+	}
+}
+
 /**
  * Clear IPI for a target HART
  *
@@ -559,6 +639,22 @@ static inline void sbi_platform_ipi_clear(const struct sbi_platform *plat,
 		sbi_platform_ops(plat)->ipi_clear(target_hart);
 }
 
+/**
+ * Raise supervisor software interrupt directly on a target HART
+ *
+ * @param plat pointer to struct sbi_platform
+ * @param target_hart HART ID of IPI target
+ *
+ * @return 0 on success and SBI_ENOTSUPP if target HART has no such device
+ */
+static inline int sbi_platform_ipi_send_smode(const struct sbi_platform *plat,
+					      u32 target_hart)
+{
+	if (plat && sbi_platform_ops(plat)->ipi_send_smode)
+		return sbi_platform_ops(plat)->ipi_send_smode(target_hart);
+	return SBI_ENOTSUPP;
+}
+
 /**
  * Initialize the platform IPI support for current HART
  *
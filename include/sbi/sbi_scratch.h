@@ -75,6 +75,21 @@ enum sbi_scratch_options {
 	SBI_SCRATCH_NO_BOOT_PRINTS = (1 << 0),
 	/** Enable runtime debug prints */
 	SBI_SCRATCH_DEBUG_PRINTS = (1 << 1),
+	/**
+	 * Trap supervisor WFI so that idle HARTs get remote TLB flushes
+	 * on wake up instead of being interrupted
+	 */
+	SBI_SCRATCH_LAZY_TLB_FLUSH = (1 << 2),
+	/**
+	 * Periodically re-calibrate time delta between timer devices
+	 * (such as multiple CLINTs) from the M-mode timer interrupt
+	 */
+	SBI_SCRATCH_TIME_DELTA_RECALIBRATE = (1 << 3),
+	/**
+	 * Record timestamps of boot stages on every HART and print the
+	 * coldboot HART profile at the end of cold boot
+	 */
+	SBI_SCRATCH_BOOT_PROFILE = (1 << 4),
 };
 
 /** Get pointer to sbi_scratch for current HART */
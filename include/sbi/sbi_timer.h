@@ -10,10 +10,50 @@
 #ifndef __SBI_TIMER_H__
 #define __SBI_TIMER_H__
 
+/* clang-format off */
+
+/** Maximum number of pending M-mode timer events per HART */
+#define SBI_TIMER_QUEUE_MAX_EVENTS		8
+
+/** Offset of time_val member in sbi_timer_fast_read */
+#define SBI_TIMER_FAST_READ_TIME_VAL_OFFSET	(0 * __SIZEOF_POINTER__)
+/** Offset of time_delta member in sbi_timer_fast_read */
+#define SBI_TIMER_FAST_READ_TIME_DELTA_OFFSET	(1 * __SIZEOF_POINTER__)
+
+/* clang-format on */
+
+#ifndef __ASSEMBLY__
+
 #include <sbi/sbi_types.h>
 
+/** Per-HART MMIO time source used to emulate TIME CSR reads in assembly */
+struct sbi_timer_fast_read {
+	/** Address of 64-bit time counter (zero if not available) */
+	unsigned long time_val;
+	/** Address of 64-bit value added to the time counter */
+	unsigned long time_delta;
+} __packed;
+
+/** Scratch offset of struct sbi_timer_fast_read (used by trap entry) */
+extern unsigned long sbi_timer_fast_read_off;
+
+/** Timer event handled in M-mode on the HART which added it */
+struct sbi_timer_event {
+	/** Absolute time (in timer ticks) at which the event expires */
+	u64 deadline;
+	/** Called from M-mode timer interrupt after the event expired */
+	void (*callback)(struct sbi_timer_event *ev);
+	/** Position in the timer queue (private to sbi_timer) */
+	u32 index;
+	/** Event is in the timer queue (private to sbi_timer) */
+	bool pending;
+};
+
 struct sbi_scratch;
 
+/** Check whether timer value can be read (i.e. after cold boot timer init) */
+bool sbi_timer_value_ready(void);
+
 /** Get timer value for current HART */
 u64 sbi_timer_value(void);
 
@@ -29,9 +69,18 @@ void sbi_timer_set_delta(ulong delta);
 /** Set upper 32-bits of timer delta value for current HART */
 void sbi_timer_set_delta_upper(ulong delta_upper);
 
+/** Set MMIO time source of TIME CSR read fast path for current HART */
+void sbi_timer_set_fast_read(volatile u64 *time_val, u64 *time_delta);
+
 /** Start timer event for current HART */
 void sbi_timer_event_start(u64 next_event);
 
+/** Add (or move) M-mode timer event of current HART */
+int sbi_timer_event_add(struct sbi_timer_event *ev, u64 deadline);
+
+/** Remove M-mode timer event of current HART */
+void sbi_timer_event_cancel(struct sbi_timer_event *ev);
+
 /** Process timer event for current HART */
 void sbi_timer_process(void);
 
@@ -42,3 +91,5 @@ int sbi_timer_init(struct sbi_scratch *scratch, bool cold_boot);
 void sbi_timer_exit(struct sbi_scratch *scratch);
 
 #endif
+
+#endif
@@ -20,6 +20,7 @@
 
 /* clang-format on */
 
+/* Note: must be a power of two (see sbi_mpsc_fifo_init()) */
 #define SBI_TLB_FIFO_NUM_ENTRIES		8
 
 enum sbi_tlb_info_types {
@@ -57,6 +58,29 @@ do { \
 
 int sbi_tlb_request(ulong hmask, ulong hbase, struct sbi_tlb_info *tinfo);
 
+int sbi_tlb_request_async(ulong hmask, ulong hbase,
+			  struct sbi_tlb_info *tinfo, ulong *ticket);
+
+int sbi_tlb_ticket_status(ulong ticket);
+
+int sbi_tlb_ticket_wait(ulong ticket);
+
+/** Number of requests sent by given HART that were merged into queued ones */
+unsigned long sbi_tlb_coalesced_count(struct sbi_scratch *scratch);
+
+/**
+ * Range size (in bytes) above which remote TLB range requests are
+ * upgraded to a full flush. The optional calibrated output tells
+ * whether the value was measured at boot time.
+ */
+unsigned long sbi_tlb_range_flush_limit(bool *calibrated);
+
+/** Mark current HART idle so remote TLB requests are deferred to wake up */
+void sbi_tlb_idle_enter(struct sbi_scratch *scratch);
+
+/** Mark current HART awake and apply any deferred TLB flush */
+void sbi_tlb_idle_exit(struct sbi_scratch *scratch);
+
 int sbi_tlb_init(struct sbi_scratch *scratch, bool cold_boot);
 
 extern unsigned long tlb_sync_off;
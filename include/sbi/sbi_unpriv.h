@@ -36,6 +36,27 @@ DECLARE_UNPRIVILEGED_LOAD_FUNCTION(u64)
 DECLARE_UNPRIVILEGED_STORE_FUNCTION(u64)
 DECLARE_UNPRIVILEGED_LOAD_FUNCTION(ulong)
 
+/** Maximum number of words moved by one unprivileged MPRV window */
+#define SBI_UNPRIV_BLOCK_WORDS		4
+
+ulong sbi_load_ulong_words(const ulong *addr, ulong count, ulong *out,
+			   struct sbi_trap_info *trap);
+
+ulong sbi_store_ulong_words(ulong *addr, ulong count, const ulong *in,
+			    struct sbi_trap_info *trap);
+
+void sbi_store_ulong_bytes(ulong addr, ulong val, ulong len,
+			   struct sbi_trap_info *trap);
+
+int sbi_copy_from_lower(void *dst, const void *src, ulong len,
+			struct sbi_trap_info *trap);
+
+int sbi_copy_to_lower(void *dst, const void *src, ulong len,
+		      struct sbi_trap_info *trap);
+
+long sbi_strncpy_from_lower(char *dst, const char *src, ulong len,
+			    struct sbi_trap_info *trap);
+
 ulong sbi_get_insn(ulong mepc, struct sbi_trap_info *trap);
 
 #endif
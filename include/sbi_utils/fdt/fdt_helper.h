@@ -35,6 +35,9 @@ int fdt_find_match(void *fdt, int startoff,
 int fdt_get_node_addr_size(void *fdt, int node, unsigned long *addr,
 			   unsigned long *size);
 
+int fdt_get_node_addr_size_index(void *fdt, int node, int index,
+				 unsigned long *addr, unsigned long *size);
+
 int fdt_parse_hart_id(void *fdt, int cpu_offset, u32 *hartid);
 
 int fdt_parse_max_hart_id(void *fdt, u32 *max_hartid);
@@ -62,6 +65,14 @@ struct clint_data;
 int fdt_parse_clint_node(void *fdt, int nodeoffset, bool for_timer,
 			 struct clint_data *clint);
 
+struct aclint_sswi_data;
+
+int fdt_parse_aclint_mtimer_node(void *fdt, int nodeoffset,
+				 struct clint_data *mtimer);
+
+int fdt_parse_aclint_sswi_node(void *fdt, int nodeoffset,
+			       struct aclint_sswi_data *sswi);
+
 int fdt_parse_compat_addr(void *fdt, unsigned long *addr,
 			  const char *compatible);
 
@@ -18,13 +18,19 @@ struct fdt_ipi {
 	int (*warm_init)(void);
 	void (*exit)(void);
 	void (*send)(u32 target_hart);
+	void (*send_mask)(ulong hmask, ulong hbase);
 	void (*clear)(u32 target_hart);
+	int (*send_smode)(u32 target_hart);
 };
 
 void fdt_ipi_send(u32 target_hart);
 
+void fdt_ipi_send_mask(ulong hmask, ulong hbase);
+
 void fdt_ipi_clear(u32 target_hart);
 
+int fdt_ipi_send_smode(u32 target_hart);
+
 void fdt_ipi_exit(void);
 
 int fdt_ipi_init(bool cold_boot);
@@ -0,0 +1,29 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#ifndef __SYS_ACLINT_H__
+#define __SYS_ACLINT_H__
+
+#include <sbi/sbi_types.h>
+
+/*
+ * Note: The ACLINT MSWI and MTIMER devices are register compatible with
+ * the IPI and timer parts of CLINT so they are handled by the CLINT
+ * library. Only the SSWI device needs a separate driver.
+ */
+
+struct aclint_sswi_data {
+	/* Public details */
+	unsigned long addr;
+	u32 first_hartid;
+	u32 hart_count;
+	/* Private details (initialized and used by ACLINT library)*/
+	u32 *setssip;
+};
+
+int aclint_sswi_send(u32 target_hart);
+
+int aclint_sswi_cold_init(struct aclint_sswi_data *sswi);
+
+#endif
@@ -11,6 +11,7 @@
 #define __SYS_CLINT_H__
 
 #include <sbi/sbi_types.h>
+#include <sbi/sbi_timer.h>
 
 struct clint_data {
 	/* Public details */
@@ -18,11 +19,17 @@ struct clint_data {
 	u32 first_hartid;
 	u32 hart_count;
 	bool has_64bit_mmio;
+	bool is_aclint_mtimer;
+	/* ACLINT MTIMER register addresses (only if is_aclint_mtimer) */
+	unsigned long mtime_addr;
+	unsigned long mtimecmp_addr;
 	/* Private details (initialized and used by CLINT library)*/
 	u32 *ipi;
 	struct clint_data *time_delta_reference;
 	unsigned long time_delta_computed;
 	u64 time_delta;
+	u64 time_delta_error;
+	struct sbi_timer_event time_delta_event;
 	u64 *time_val;
 	u64 *time_cmp;
 	u64 (*time_rd)(volatile u64 *addr);
@@ -31,6 +38,8 @@ struct clint_data {
 
 void clint_ipi_send(u32 target_hart);
 
+void clint_ipi_send_mask(ulong hmask, ulong hbase);
+
 void clint_ipi_clear(u32 target_hart);
 
 int clint_warm_ipi_init(void);
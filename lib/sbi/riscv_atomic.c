@@ -244,6 +244,18 @@ inline int atomic_raw_clear_bit(int nr, volatile unsigned long *addr)
 	return __atomic_op_bit(and, __NOT, nr, addr);
 }
 
+unsigned long atomic_raw_test_and_set_bit(int nr,
+					  volatile unsigned long *addr)
+{
+	return __atomic_op_bit(or, __NOP, nr, addr);
+}
+
+unsigned long atomic_raw_test_and_clear_bit(int nr,
+					    volatile unsigned long *addr)
+{
+	return __atomic_op_bit(and, __NOT, nr, addr);
+}
+
 inline int atomic_set_bit(int nr, atomic_t *atom)
 {
 	return atomic_raw_set_bit(nr, (unsigned long *)&atom->counter);
@@ -0,0 +1,176 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <sbi/riscv_asm.h>
+#include <sbi/riscv_encoding.h>
+#include <sbi/sbi_boot_profile.h>
+#include <sbi/sbi_console.h>
+#include <sbi/sbi_error.h>
+#include <sbi/sbi_hartmask.h>
+#include <sbi/sbi_scratch.h>
+#include <sbi/sbi_timer.h>
+
+static unsigned long boot_profile_off;
+
+static const char *const boot_stage_names[SBI_BOOT_STAGE_MAX] = {
+	[SBI_BOOT_STAGE_ENTRY]		 = "entry",
+	[SBI_BOOT_STAGE_SCRATCH]	 = "scratch",
+	[SBI_BOOT_STAGE_DOMAIN]		 = "domain",
+	[SBI_BOOT_STAGE_COLDBOOT_WAIT]	 = "coldboot-wait",
+	[SBI_BOOT_STAGE_HSM]		 = "hsm",
+	[SBI_BOOT_STAGE_PLATFORM_EARLY]	 = "platform-early",
+	[SBI_BOOT_STAGE_HART]		 = "hart",
+	[SBI_BOOT_STAGE_CONSOLE]	 = "console",
+	[SBI_BOOT_STAGE_IRQCHIP]	 = "irqchip",
+	[SBI_BOOT_STAGE_IPI]		 = "ipi",
+	[SBI_BOOT_STAGE_TLB]		 = "tlb",
+	[SBI_BOOT_STAGE_TIMER]		 = "timer",
+	[SBI_BOOT_STAGE_ECALL]		 = "ecall",
+	[SBI_BOOT_STAGE_DOMAIN_FINALIZE] = "domain-finalize",
+	[SBI_BOOT_STAGE_PMP]		 = "pmp",
+	[SBI_BOOT_STAGE_PLATFORM_FINAL]	 = "platform-final",
+	[SBI_BOOT_STAGE_BANNER]		 = "banner",
+	[SBI_BOOT_STAGE_GENERAL_INFO]	 = "general-info",
+	[SBI_BOOT_STAGE_DOMAIN_INFO]	 = "domain-info",
+	[SBI_BOOT_STAGE_HART_INFO]	 = "hart-info",
+};
+
+u64 sbi_boot_profile_cycle(void)
+{
+#if __riscv_xlen == 32
+	u32 lo, hi, tmp;
+
+	do {
+		hi = csr_read(CSR_MCYCLEH);
+		lo = csr_read(CSR_MCYCLE);
+		tmp = csr_read(CSR_MCYCLEH);
+	} while (hi != tmp);
+
+	return ((u64)hi << 32) | lo;
+#else
+	return csr_read(CSR_MCYCLE);
+#endif
+}
+
+static void boot_profile_record(struct sbi_boot_profile *prof, u32 stage,
+				u64 cycle, u64 time)
+{
+	struct sbi_boot_profile_record *rec;
+
+	if (SBI_BOOT_PROFILE_MAX_RECORDS <= prof->count)
+		return;
+
+	rec = &prof->records[prof->count];
+	rec->stage = stage;
+	rec->reserved = 0;
+	rec->cycle = cycle;
+	rec->time = time;
+	prof->count++;
+}
+
+/**
+ * Start boot profiling for current HART
+ * @param scratch the scratch space of current HART
+ * @param cold_boot TRUE for the coldboot HART
+ * @param entry_cycle MCYCLE value sampled when entering sbi_init
+ * @return 0 on success and SBI_Exxx (< 0) on failure
+ * Note: does nothing unless SBI_SCRATCH_BOOT_PROFILE option is set.
+ */
+int sbi_boot_profile_init(struct sbi_scratch *scratch, bool cold_boot,
+			  u64 entry_cycle)
+{
+	struct sbi_boot_profile *prof;
+
+	if (!(scratch->options & SBI_SCRATCH_BOOT_PROFILE))
+		return 0;
+
+	if (cold_boot) {
+		boot_profile_off = sbi_scratch_alloc_offset(sizeof(*prof),
+							    "BOOT_PROFILE");
+		if (!boot_profile_off)
+			return SBI_ENOMEM;
+	} else {
+		if (!boot_profile_off)
+			return SBI_ENOMEM;
+	}
+
+	/* Earlier records (if any) belong to a previous boot of this HART */
+	prof = sbi_scratch_offset_ptr(scratch, boot_profile_off);
+	prof->count = 0;
+	prof->cold_boot = (cold_boot) ? 1 : 0;
+	/* Only MCYCLE was sampled at entry */
+	boot_profile_record(prof, SBI_BOOT_STAGE_ENTRY, entry_cycle, 0);
+
+	return 0;
+}
+
+void sbi_boot_profile_mark(struct sbi_scratch *scratch,
+			   enum sbi_boot_stage stage)
+{
+	if (!boot_profile_off)
+		return;
+
+	boot_profile_record(sbi_scratch_offset_ptr(scratch, boot_profile_off),
+			    stage, sbi_boot_profile_cycle(),
+			    (sbi_timer_value_ready()) ? sbi_timer_value() : 0);
+}
+
+/**
+ * Get boot profile of a HART
+ * @param hartid the HART to look at
+ * @return pointer to boot profile or NULL if profiling is disabled
+ */
+const struct sbi_boot_profile *sbi_boot_profile_get(u32 hartid)
+{
+	struct sbi_scratch *scratch;
+
+	if (!boot_profile_off)
+		return NULL;
+
+	scratch = sbi_hartid_to_scratch(hartid);
+	if (!scratch)
+		return NULL;
+
+	return sbi_scratch_offset_ptr(scratch, boot_profile_off);
+}
+
+const char *sbi_boot_profile_stage_name(u32 stage)
+{
+	if (SBI_BOOT_STAGE_MAX <= stage)
+		return "unknown";
+
+	return boot_stage_names[stage];
+}
+
+void sbi_boot_profile_dump(struct sbi_scratch *scratch)
+{
+	u32 i;
+	u64 cycles, ticks;
+	const struct sbi_boot_profile_record *rec, *prev;
+	const struct sbi_boot_profile *prof;
+
+	if (!boot_profile_off)
+		return;
+
+	prof = sbi_scratch_offset_ptr(scratch, boot_profile_off);
+	if (!prof->count)
+		return;
+
+	sbi_printf("Boot Profile (HART %u)\n", current_hartid());
+	sbi_printf("  %-16s %16s %16s\n", "Stage", "Cycles", "Ticks");
+	for (i = 1; i < prof->count; i++) {
+		rec = &prof->records[i];
+		prev = &prof->records[i - 1];
+		cycles = rec->cycle - prev->cycle;
+		ticks = (prev->time) ? rec->time - prev->time : 0;
+		sbi_printf("  %-16s %16llu %16llu\n",
+			   sbi_boot_profile_stage_name(rec->stage),
+			   (unsigned long long)cycles,
+			   (unsigned long long)ticks);
+	}
+	rec = &prof->records[prof->count - 1];
+	sbi_printf("  %-16s %16llu\n", "total",
+		   (unsigned long long)(rec->cycle - prof->records[0].cycle));
+	sbi_printf("\n");
+}
@@ -11,6 +11,7 @@
 #include <sbi/sbi_ecall.h>
 #include <sbi/sbi_ecall_interface.h>
 #include <sbi/sbi_error.h>
+#include <sbi/sbi_string.h>
 #include <sbi/sbi_trap.h>
 
 u16 sbi_ecall_version_major(void)
@@ -37,18 +38,131 @@ void sbi_ecall_set_impid(unsigned long impid)
 
 static SBI_LIST_HEAD(ecall_exts_list);
 
-struct sbi_ecall_extension *sbi_ecall_find_extension(unsigned long extid)
+/*
+ * Extensions are looked up through two tables which are filled as
+ * extensions are registered and rebuilt from ecall_exts_list whenever
+ * an extension is unregistered:
+ * - extensions with a single extension ID live in an open-addressed hash
+ *   table which is kept at most half full
+ * - extensions covering a range of extension IDs (legacy, vendor, etc)
+ *   live in an array sorted by extid_start which is binary searched
+ * This makes the lookup cost independent of registration order.
+ * Extensions which do not fit in the tables are only on ecall_exts_list
+ * and are found by walking it after both tables missed.
+ */
+#define SBI_ECALL_HASH_SIZE		(1UL << SBI_ECALL_HASH_BITS)
+
+static struct sbi_ecall_extension *ecall_hash[SBI_ECALL_HASH_SIZE];
+static struct sbi_ecall_extension *ecall_ranges[SBI_ECALL_MAX_RANGES];
+static unsigned long ecall_hash_count;
+static unsigned long ecall_range_count;
+static unsigned long ecall_overflow_count;
+
+static inline unsigned long sbi_ecall_hash(unsigned long extid)
+{
+	u32 key = (u32)extid;
+
+#if __riscv_xlen == 64
+	key ^= (u32)(extid >> 32);
+#endif
+
+	return (key * 0x9e3779b1U) >> (32 - SBI_ECALL_HASH_BITS);
+}
+
+static inline bool sbi_ecall_is_range(struct sbi_ecall_extension *ext)
+{
+	return (ext->extid_start != ext->extid_end) ? TRUE : FALSE;
+}
+
+static void sbi_ecall_hash_add(struct sbi_ecall_extension *ext)
 {
-	struct sbi_ecall_extension *t, *ret = NULL;
+	unsigned long i = sbi_ecall_hash(ext->extid_start);
+
+	if (SBI_ECALL_MAX_EXTIDS <= ecall_hash_count) {
+		ecall_overflow_count++;
+		return;
+	}
+
+	while (ecall_hash[i])
+		i = (i + 1) & (SBI_ECALL_HASH_SIZE - 1);
+	ecall_hash[i] = ext;
+	ecall_hash_count++;
+}
+
+static void sbi_ecall_range_add(struct sbi_ecall_extension *ext)
+{
+	unsigned long i = ecall_range_count;
+
+	if (SBI_ECALL_MAX_RANGES <= ecall_range_count) {
+		ecall_overflow_count++;
+		return;
+	}
+
+	while (i && ext->extid_start < ecall_ranges[i - 1]->extid_start) {
+		ecall_ranges[i] = ecall_ranges[i - 1];
+		i--;
+	}
+	ecall_ranges[i] = ext;
+	ecall_range_count++;
+}
+
+static void sbi_ecall_rebuild_tables(void)
+{
+	struct sbi_ecall_extension *t;
+
+	sbi_memset(ecall_hash, 0, sizeof(ecall_hash));
+	sbi_memset(ecall_ranges, 0, sizeof(ecall_ranges));
+	ecall_hash_count = 0;
+	ecall_range_count = 0;
+	ecall_overflow_count = 0;
 
 	sbi_list_for_each_entry(t, &ecall_exts_list, head) {
-		if (t->extid_start <= extid && extid <= t->extid_end) {
-			ret = t;
+		if (sbi_ecall_is_range(t))
+			sbi_ecall_range_add(t);
+		else
+			sbi_ecall_hash_add(t);
+	}
+}
+
+struct sbi_ecall_extension *sbi_ecall_find_extension(unsigned long extid)
+{
+	struct sbi_ecall_extension *t;
+	unsigned long i, n, lo, hi, mid;
+
+	/* Single extension ID lookup */
+	i = sbi_ecall_hash(extid);
+	for (n = 0; n < SBI_ECALL_HASH_SIZE; n++) {
+		t = ecall_hash[i];
+		if (!t)
 			break;
+		if (t->extid_start == extid)
+			return t;
+		i = (i + 1) & (SBI_ECALL_HASH_SIZE - 1);
+	}
+
+	/* Extension ID range lookup */
+	lo = 0;
+	hi = ecall_range_count;
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		t = ecall_ranges[mid];
+		if (extid < t->extid_start)
+			hi = mid;
+		else if (t->extid_end < extid)
+			lo = mid + 1;
+		else
+			return t;
+	}
+
+	/* Extensions which did not fit in the tables */
+	if (ecall_overflow_count) {
+		sbi_list_for_each_entry(t, &ecall_exts_list, head) {
+			if (t->extid_start <= extid && extid <= t->extid_end)
+				return t;
 		}
 	}
 
-	return ret;
+	return NULL;
 }
 
 int sbi_ecall_register_extension(struct sbi_ecall_extension *ext)
@@ -70,6 +184,11 @@ int sbi_ecall_register_extension(struct sbi_ecall_extension *ext)
 	SBI_INIT_LIST_HEAD(&ext->head);
 	sbi_list_add_tail(&ext->head, &ecall_exts_list);
 
+	if (sbi_ecall_is_range(ext))
+		sbi_ecall_range_add(ext);
+	else
+		sbi_ecall_hash_add(ext);
+
 	return 0;
 }
 
@@ -88,8 +207,10 @@ void sbi_ecall_unregister_extension(struct sbi_ecall_extension *ext)
 		}
 	}
 
-	if (found)
+	if (found) {
 		sbi_list_del_init(&ext->head);
+		sbi_ecall_rebuild_tables();
+	}
 }
 
 int sbi_ecall_handler(struct sbi_trap_regs *regs)
@@ -155,7 +276,7 @@ int sbi_ecall_init(void)
 {
 	int ret;
 
-	/* The order of below registrations is performance optimized */
+	/* Lookup does not depend on the order of below registrations */
 	ret = sbi_ecall_register_extension(&ecall_time);
 	if (ret)
 		return ret;
@@ -178,6 +299,12 @@ int sbi_ecall_init(void)
 	if (ret)
 		return ret;
 	ret = sbi_ecall_register_extension(&ecall_vendor);
+	if (ret)
+		return ret;
+	ret = sbi_ecall_register_extension(&ecall_async_rfence);
+	if (ret)
+		return ret;
+	ret = sbi_ecall_register_extension(&ecall_boot_profile);
 	if (ret)
 		return ret;
 
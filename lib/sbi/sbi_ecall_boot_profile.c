@@ -0,0 +1,82 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <sbi/riscv_asm.h>
+#include <sbi/sbi_boot_profile.h>
+#include <sbi/sbi_domain.h>
+#include <sbi/sbi_ecall.h>
+#include <sbi/sbi_ecall_interface.h>
+#include <sbi/sbi_error.h>
+#include <sbi/sbi_hartmask.h>
+#include <sbi/sbi_hsm.h>
+#include <sbi/sbi_scratch.h>
+#include <sbi/sbi_unpriv.h>
+
+static int sbi_ecall_boot_profile_probe(unsigned long extid,
+					unsigned long *out_val)
+{
+	*out_val = (sbi_boot_profile_get(current_hartid())) ? 1 : 0;
+	return 0;
+}
+
+static int sbi_ecall_boot_profile_handler(unsigned long extid,
+					  unsigned long funcid,
+					  struct sbi_trap_regs *regs,
+					  unsigned long *args,
+					  unsigned long *out_val,
+					  struct sbi_trap_info *out_trap)
+{
+	int ret;
+	u64 last, max;
+	struct sbi_scratch *scratch;
+	const struct sbi_boot_profile *prof;
+
+	if (!sbi_boot_profile_get(current_hartid()))
+		return SBI_ENOTSUPP;
+
+	switch (funcid) {
+	case SBI_EXT_BOOT_PROFILE_GET_SIZE:
+		*out_val = sizeof(*prof);
+		return 0;
+	case SBI_EXT_BOOT_PROFILE_READ:
+		/* args[0] = hartid, args[1] = address, args[2] = size */
+		if (!sbi_domain_is_assigned_hart(sbi_domain_thishart_ptr(),
+						 args[0]))
+			return SBI_EINVAL;
+		prof = sbi_boot_profile_get(args[0]);
+		if (!prof || args[2] < sizeof(*prof))
+			return SBI_EINVAL;
+
+		/* Copy through the caller's translation and permissions */
+		ret = sbi_copy_to_lower((void *)args[1], prof, sizeof(*prof),
+					out_trap);
+		if (ret)
+			return ret;
+		*out_val = sizeof(*prof);
+		return 0;
+	case SBI_EXT_BOOT_PROFILE_RESUME_LATENCY:
+		/* args[0] = hartid, args[1] = 0 for last or 1 for max */
+		if (!sbi_domain_is_assigned_hart(sbi_domain_thishart_ptr(),
+						 args[0]))
+			return SBI_EINVAL;
+		scratch = sbi_hartid_to_scratch(args[0]);
+		if (!scratch || 1 < args[1])
+			return SBI_EINVAL;
+
+		sbi_hsm_hart_resume_latency(scratch, &last, &max);
+		*out_val = (args[1]) ? max : last;
+		return 0;
+	default:
+		break;
+	}
+
+	return SBI_ENOTSUPP;
+}
+
+struct sbi_ecall_extension ecall_boot_profile = {
+	.extid_start = SBI_EXT_OPENSBI_BOOT_PROFILE,
+	.extid_end = SBI_EXT_OPENSBI_BOOT_PROFILE,
+	.probe = sbi_ecall_boot_profile_probe,
+	.handle = sbi_ecall_boot_profile_handler,
+};
@@ -40,6 +40,17 @@ static int sbi_ecall_hsm_handler(unsigned long extid, unsigned long funcid,
 						args[0]);
 		ret = sbi_hsm_hart_state_to_status(hstate);
 		break;
+	case SBI_EXT_HSM_HART_SUSPEND:
+		smode = csr_read(CSR_MSTATUS);
+		smode = (smode & MSTATUS_MPP) >> MSTATUS_MPP_SHIFT;
+		/* Suspend type is 32-bit wide, reject anything bigger */
+		if ((u32)args[0] != args[0]) {
+			ret = SBI_EINVAL;
+			break;
+		}
+		ret = sbi_hsm_hart_suspend(scratch, args[0], args[1],
+					   smode, args[2]);
+		break;
 	default:
 		ret = SBI_ENOTSUPP;
 	};
@@ -43,66 +43,70 @@ struct sbi_ecall_extension ecall_time = {
 	.handle = sbi_ecall_time_handler,
 };
 
-static int sbi_ecall_rfence_handler(unsigned long extid, unsigned long funcid,
-            struct sbi_trap_regs *regs,
-				    unsigned long *args, unsigned long *out_val,
-				    struct sbi_trap_info *out_trap)
+static int sbi_ecall_rfence_info(unsigned long funcid, unsigned long *args,
+				 struct sbi_tlb_info *tlb_info)
 {
-	int ret = 0;
 	unsigned long vmid;
-	struct sbi_tlb_info tlb_info;
 	u32 source_hart = current_hartid();
 
 	if (funcid >= SBI_EXT_RFENCE_REMOTE_HFENCE_GVMA &&
 	    funcid <= SBI_EXT_RFENCE_REMOTE_HFENCE_VVMA_ASID)
-		if (!misa_extension('H'))
+		if (!sbi_hart_has_extension(sbi_scratch_thishart_ptr(), 'H'))
 			return SBI_ENOTSUPP;
 
 	switch (funcid) {
 	case SBI_EXT_RFENCE_REMOTE_FENCE_I:
-		SBI_TLB_INFO_INIT(&tlb_info, 0, 0, 0, 0,
+		SBI_TLB_INFO_INIT(tlb_info, 0, 0, 0, 0,
 				  SBI_ITLB_FLUSH, source_hart);
-		ret = sbi_tlb_request(args[0], args[1], &tlb_info);
 		break;
 	case SBI_EXT_RFENCE_REMOTE_HFENCE_GVMA:
-		SBI_TLB_INFO_INIT(&tlb_info, args[2], args[3], 0, 0,
+		SBI_TLB_INFO_INIT(tlb_info, args[2], args[3], 0, 0,
 				  SBI_TLB_FLUSH_GVMA, source_hart);
-		ret = sbi_tlb_request(args[0], args[1], &tlb_info);
 		break;
 	case SBI_EXT_RFENCE_REMOTE_HFENCE_GVMA_VMID:
-		SBI_TLB_INFO_INIT(&tlb_info, args[2], args[3], 0, args[4],
+		SBI_TLB_INFO_INIT(tlb_info, args[2], args[3], 0, args[4],
 				  SBI_TLB_FLUSH_GVMA_VMID, source_hart);
-		ret = sbi_tlb_request(args[0], args[1], &tlb_info);
 		break;
 	case SBI_EXT_RFENCE_REMOTE_HFENCE_VVMA:
 		vmid = (csr_read(CSR_HGATP) & HGATP_VMID_MASK);
 		vmid = vmid >> HGATP_VMID_SHIFT;
-		SBI_TLB_INFO_INIT(&tlb_info, args[2], args[3], 0, vmid,
+		SBI_TLB_INFO_INIT(tlb_info, args[2], args[3], 0, vmid,
 				  SBI_TLB_FLUSH_VVMA, source_hart);
-		ret = sbi_tlb_request(args[0], args[1], &tlb_info);
 		break;
 	case SBI_EXT_RFENCE_REMOTE_HFENCE_VVMA_ASID:
 		vmid = (csr_read(CSR_HGATP) & HGATP_VMID_MASK);
 		vmid = vmid >> HGATP_VMID_SHIFT;
-		SBI_TLB_INFO_INIT(&tlb_info, args[2], args[3], args[4], vmid,
+		SBI_TLB_INFO_INIT(tlb_info, args[2], args[3], args[4], vmid,
 				  SBI_TLB_FLUSH_VVMA_ASID, source_hart);
-		ret = sbi_tlb_request(args[0], args[1], &tlb_info);
 		break;
 	case SBI_EXT_RFENCE_REMOTE_SFENCE_VMA:
-		SBI_TLB_INFO_INIT(&tlb_info, args[2], args[3], 0, 0,
+		SBI_TLB_INFO_INIT(tlb_info, args[2], args[3], 0, 0,
 				  SBI_TLB_FLUSH_VMA, source_hart);
-		ret = sbi_tlb_request(args[0], args[1], &tlb_info);
 		break;
 	case SBI_EXT_RFENCE_REMOTE_SFENCE_VMA_ASID:
-		SBI_TLB_INFO_INIT(&tlb_info, args[2], args[3], args[4], 0,
+		SBI_TLB_INFO_INIT(tlb_info, args[2], args[3], args[4], 0,
 				  SBI_TLB_FLUSH_VMA_ASID, source_hart);
-		ret = sbi_tlb_request(args[0], args[1], &tlb_info);
 		break;
 	default:
-		ret = SBI_ENOTSUPP;
+		return SBI_ENOTSUPP;
 	};
 
-	return ret;
+	return 0;
+}
+
+static int sbi_ecall_rfence_handler(unsigned long extid, unsigned long funcid,
+            struct sbi_trap_regs *regs,
+				    unsigned long *args, unsigned long *out_val,
+				    struct sbi_trap_info *out_trap)
+{
+	int ret;
+	struct sbi_tlb_info tlb_info;
+
+	ret = sbi_ecall_rfence_info(funcid, args, &tlb_info);
+	if (ret)
+		return ret;
+
+	return sbi_tlb_request(args[0], args[1], &tlb_info);
 }
 
 struct sbi_ecall_extension ecall_rfence = {
@@ -111,6 +115,42 @@ struct sbi_ecall_extension ecall_rfence = {
 	.handle = sbi_ecall_rfence_handler,
 };
 
+static int sbi_ecall_async_rfence_handler(unsigned long extid,
+					  unsigned long funcid,
+					  struct sbi_trap_regs *regs,
+					  unsigned long *args,
+					  unsigned long *out_val,
+					  struct sbi_trap_info *out_trap)
+{
+	int ret;
+	struct sbi_tlb_info tlb_info;
+
+	switch (funcid) {
+	case SBI_EXT_ASYNC_RFENCE_TICKET_POLL:
+		ret = sbi_tlb_ticket_status(args[0]);
+		if (ret < 0)
+			return ret;
+		*out_val = ret;
+		return 0;
+	case SBI_EXT_ASYNC_RFENCE_TICKET_WAIT:
+		return sbi_tlb_ticket_wait(args[0]);
+	default:
+		break;
+	}
+
+	ret = sbi_ecall_rfence_info(funcid, args, &tlb_info);
+	if (ret)
+		return ret;
+
+	return sbi_tlb_request_async(args[0], args[1], &tlb_info, out_val);
+}
+
+struct sbi_ecall_extension ecall_async_rfence = {
+	.extid_start = SBI_EXT_OPENSBI_ASYNC_RFENCE,
+	.extid_end = SBI_EXT_OPENSBI_ASYNC_RFENCE,
+	.handle = sbi_ecall_async_rfence_handler,
+};
+
 static int sbi_ecall_ipi_handler(unsigned long extid, unsigned long funcid,
          struct sbi_trap_regs *regs,
 				 unsigned long *args, unsigned long *out_val,
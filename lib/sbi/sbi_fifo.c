@@ -7,6 +7,7 @@
  *   Atish Patra<atish.patra@wdc.com>
  *
  */
+#include <sbi/riscv_barrier.h>
 #include <sbi/riscv_locks.h>
 #include <sbi/sbi_error.h>
 #include <sbi/sbi_fifo.h>
@@ -190,3 +191,183 @@ int sbi_fifo_dequeue(struct sbi_fifo *fifo, void *data)
 
 	return 0;
 }
+
+/*
+ * Slot sequence numbers of sbi_mpsc_fifo advance in steps of two so that
+ * the lowest bit can mark a published slot as claimed (either by the
+ * consumer while copying it out or by a producer doing an inplace update).
+ */
+#define MPSC_SEQ_FREE(__pos)		((unsigned long)(__pos) << 1)
+#define MPSC_SEQ_FULL(__pos)		MPSC_SEQ_FREE((__pos) + 1)
+#define MPSC_SEQ_BUSY(__pos)		(MPSC_SEQ_FULL(__pos) | 1UL)
+
+static inline struct sbi_mpsc_fifo_slot *__sbi_mpsc_fifo_slot(
+					struct sbi_mpsc_fifo *fifo,
+					unsigned long pos)
+{
+	pos &= (fifo->num_entries - 1);
+
+	return fifo->queue + pos * fifo->slot_size;
+}
+
+static inline void *__sbi_mpsc_fifo_slot_data(struct sbi_mpsc_fifo_slot *slot)
+{
+	return (void *)slot + sizeof(*slot);
+}
+
+static inline unsigned long __sbi_mpsc_fifo_seq(struct sbi_mpsc_fifo_slot *slot)
+{
+	return (unsigned long)__smp_load_acquire(&slot->seq.counter);
+}
+
+static inline bool __sbi_mpsc_fifo_claim(struct sbi_mpsc_fifo_slot *slot,
+					 unsigned long pos)
+{
+	return (unsigned long)atomic_cmpxchg(&slot->seq, MPSC_SEQ_FULL(pos),
+				MPSC_SEQ_BUSY(pos)) == MPSC_SEQ_FULL(pos);
+}
+
+/**
+ * Initialize a lock-free MPSC fifo
+ *
+ * The queue_mem must be at least entries * SBI_MPSC_FIFO_SLOT_SIZE(entry_size)
+ * bytes and entries must be a power of two.
+ */
+int sbi_mpsc_fifo_init(struct sbi_mpsc_fifo *fifo, void *queue_mem,
+		       u16 entries, u16 entry_size)
+{
+	u16 i;
+	struct sbi_mpsc_fifo_slot *slot;
+
+	if (!fifo || !queue_mem || !entries || (entries & (entries - 1)))
+		return SBI_EINVAL;
+
+	fifo->queue	  = queue_mem;
+	fifo->num_entries = entries;
+	fifo->entry_size  = entry_size;
+	fifo->slot_size	  = SBI_MPSC_FIFO_SLOT_SIZE(entry_size);
+	sbi_memset(fifo->queue, 0, (size_t)entries * fifo->slot_size);
+
+	for (i = 0; i < entries; i++) {
+		slot = __sbi_mpsc_fifo_slot(fifo, i);
+		ATOMIC_INIT(&slot->seq, MPSC_SEQ_FREE(i));
+	}
+
+	fifo->tail = 0;
+	ATOMIC_INIT(&fifo->head, 0);
+	smp_wmb();
+
+	return 0;
+}
+
+bool sbi_mpsc_fifo_is_empty(struct sbi_mpsc_fifo *fifo)
+{
+	return ((unsigned long)atomic_read(&fifo->head) == fifo->tail) ?
+		TRUE : FALSE;
+}
+
+/**
+ * Enqueue an entry from any HART
+ *
+ * The producer reserves a position by advancing head with a compare and
+ * swap, copies the entry into the reserved slot without holding any lock
+ * and then publishes the slot by releasing its sequence number.
+ */
+int sbi_mpsc_fifo_enqueue(struct sbi_mpsc_fifo *fifo, void *data)
+{
+	long diff;
+	unsigned long pos;
+	struct sbi_mpsc_fifo_slot *slot;
+
+	if (!fifo || !data)
+		return SBI_EINVAL;
+
+	while (1) {
+		pos = (unsigned long)atomic_read(&fifo->head);
+		slot = __sbi_mpsc_fifo_slot(fifo, pos);
+		diff = (long)(__sbi_mpsc_fifo_seq(slot) - MPSC_SEQ_FREE(pos));
+		if (!diff) {
+			if ((unsigned long)atomic_cmpxchg(&fifo->head, pos,
+							  pos + 1) == pos)
+				break;
+		} else if (diff < 0) {
+			/* Slot of previous lap not yet consumed */
+			return SBI_ENOSPC;
+		}
+	}
+
+	sbi_memcpy(__sbi_mpsc_fifo_slot_data(slot), data, fifo->entry_size);
+	__smp_store_release(&slot->seq.counter, MPSC_SEQ_FULL(pos));
+
+	return 0;
+}
+
+/**
+ * Dequeue an entry
+ * Note: must only be called by the HART owning the fifo.
+ */
+int sbi_mpsc_fifo_dequeue(struct sbi_mpsc_fifo *fifo, void *data)
+{
+	unsigned long seq, pos;
+	struct sbi_mpsc_fifo_slot *slot;
+
+	if (!fifo || !data)
+		return SBI_EINVAL;
+
+	pos = fifo->tail;
+	slot = __sbi_mpsc_fifo_slot(fifo, pos);
+
+	while (1) {
+		seq = __sbi_mpsc_fifo_seq(slot);
+		if (seq == MPSC_SEQ_FULL(pos)) {
+			if (__sbi_mpsc_fifo_claim(slot, pos))
+				break;
+		} else if (seq != MPSC_SEQ_BUSY(pos)) {
+			/* Empty or producer has not published yet */
+			return SBI_ENOENT;
+		}
+	}
+
+	sbi_memcpy(data, __sbi_mpsc_fifo_slot_data(slot), fifo->entry_size);
+	fifo->tail = pos + 1;
+	__smp_store_release(&slot->seq.counter,
+			    MPSC_SEQ_FREE(pos + fifo->num_entries));
+
+	return 0;
+}
+
+/**
+ * Provide a helper function to do inplace update to the MPSC fifo.
+ *
+ * Unlike sbi_fifo_inplace_update(), only the slot being examined is
+ * claimed while the callback runs so producers and the consumer keep
+ * making progress on all other slots.
+ */
+int sbi_mpsc_fifo_inplace_update(struct sbi_mpsc_fifo *fifo, void *in,
+				 int (*fptr)(void *in, void *data))
+{
+	u16 i;
+	unsigned long pos, head;
+	struct sbi_mpsc_fifo_slot *slot;
+	int ret = SBI_FIFO_UNCHANGED;
+
+	if (!fifo || !in)
+		return ret;
+
+	pos = fifo->tail;
+	head = (unsigned long)atomic_read(&fifo->head);
+
+	for (i = 0; i < fifo->num_entries && pos != head; i++, pos++) {
+		slot = __sbi_mpsc_fifo_slot(fifo, pos);
+		if (!__sbi_mpsc_fifo_claim(slot, pos))
+			continue;
+
+		ret = fptr(in, __sbi_mpsc_fifo_slot_data(slot));
+		__smp_store_release(&slot->seq.counter, MPSC_SEQ_FULL(pos));
+
+		if (ret == SBI_FIFO_SKIP || ret == SBI_FIFO_UPDATED)
+			break;
+	}
+
+	return ret;
+}
@@ -35,6 +35,23 @@ struct hart_features {
 	unsigned int mhpm_count;
 };
 static unsigned long hart_features_offset;
+unsigned long hart_isa_offset;
+
+/*
+ * Probe results of the coldboot HART. On platforms which declare their
+ * HARTs homogeneous, secondary HARTs reporting the same MISA and ID CSRs
+ * reuse these instead of probing all CSRs again. The ID CSRs alone are
+ * not enough because they are often zero and clusters can differ.
+ */
+static struct {
+	bool valid;
+	unsigned long misa;
+	unsigned long mvendorid;
+	unsigned long marchid;
+	unsigned long mimpid;
+	unsigned long isa;
+	struct hart_features hfeatures;
+} boot_hart_probe;
 
 static void mstatus_init(struct sbi_scratch *scratch)
 {
@@ -48,6 +65,11 @@ static void mstatus_init(struct sbi_scratch *scratch)
 	if (misa_extension('V'))
 		mstatus_val |=  MSTATUS_VS;
 
+	/* Trap supervisor WFI to defer remote TLB flushes of idle HARTs */
+	if (misa_extension('S') &&
+	    (scratch->options & SBI_SCRATCH_LAZY_TLB_FLUSH))
+		mstatus_val |=  MSTATUS_TW;
+
 	csr_write(CSR_MSTATUS, mstatus_val);
 
 	/* Enable user/supervisor use of perf counters */
@@ -57,6 +79,20 @@ static void mstatus_init(struct sbi_scratch *scratch)
 	if (sbi_hart_has_feature(scratch, SBI_HART_HAS_MCOUNTEREN))
 		csr_write(CSR_MCOUNTEREN, -1);
 
+	/*
+	 * Let S-mode program its own timer compare. No timer event is
+	 * pending until S-mode (or the TIME extension) writes STIMECMP.
+	 */
+	if (sbi_hart_has_feature(scratch, SBI_HART_HAS_SSTC)) {
+		csr_write(CSR_STIMECMP, -1UL);
+#if __riscv_xlen == 32
+		csr_write(CSR_STIMECMPH, -1UL);
+		csr_set(CSR_MENVCFGH, ENVCFG_STCE >> 32);
+#else
+		csr_set(CSR_MENVCFG, ENVCFG_STCE);
+#endif
+	}
+
 	/* Disable all interrupts */
 	csr_write(CSR_MIE, 0);
 
@@ -262,6 +298,12 @@ static inline char *sbi_hart_feature_id2string(unsigned long feature)
 	case SBI_HART_HAS_TIME:
 		fstr = "time";
 		break;
+	case SBI_HART_HAS_SVINVAL:
+		fstr = "svinval";
+		break;
+	case SBI_HART_HAS_SSTC:
+		fstr = "sstc";
+		break;
 	default:
 		break;
 	}
@@ -312,6 +354,27 @@ done:
 		sbi_strncpy(features_str, "none", nfstr);
 }
 
+static bool hart_has_svinval(void)
+{
+	struct sbi_trap_info trap = {0};
+	register ulong tinfo asm("a3") = (ulong)&trap;
+	register ulong ttmp asm("a4");
+	register ulong mtvec = sbi_hart_expected_trap_addr();
+
+	/* Try SFENCE.W.INVAL which is illegal without Svinval */
+	asm volatile(
+		"add %[ttmp], %[tinfo], zero\n"
+		"csrrw %[mtvec], " STR(CSR_MTVEC) ", %[mtvec]\n"
+		".word 0x18000073\n"
+		"csrw " STR(CSR_MTVEC) ", %[mtvec]"
+	    : [mtvec] "+&r"(mtvec), [tinfo] "+&r"(tinfo),
+	      [ttmp] "+&r"(ttmp)
+	    :
+	    : "memory");
+
+	return (trap.cause) ? FALSE : TRUE;
+}
+
 static unsigned long hart_pmp_get_allowed_addr(void)
 {
 	unsigned long val = 0;
@@ -327,14 +390,45 @@ static unsigned long hart_pmp_get_allowed_addr(void)
 	return val;
 }
 
-static void hart_detect_features(struct sbi_scratch *scratch)
+static bool hart_probe_matches_boot_hart(struct sbi_scratch *scratch)
+{
+	if (!sbi_platform_has_homogeneous_harts(sbi_platform_ptr(scratch)))
+		return FALSE;
+
+	if (!boot_hart_probe.valid)
+		return FALSE;
+
+	return (boot_hart_probe.misa == csr_read(CSR_MISA) &&
+		boot_hart_probe.mvendorid == csr_read(CSR_MVENDORID) &&
+		boot_hart_probe.marchid == csr_read(CSR_MARCHID) &&
+		boot_hart_probe.mimpid == csr_read(CSR_MIMPID)) ? TRUE : FALSE;
+}
+
+static void hart_detect_features(struct sbi_scratch *scratch, bool cold_boot)
 {
 	struct sbi_trap_info trap = {0};
 	struct hart_features *hfeatures;
-	unsigned long val;
+	unsigned long val, *isa;
+	char ext;
 
-	/* Reset hart features */
+	isa = sbi_scratch_offset_ptr(scratch, hart_isa_offset);
 	hfeatures = sbi_scratch_offset_ptr(scratch, hart_features_offset);
+
+	if (!cold_boot && hart_probe_matches_boot_hart(scratch)) {
+		*isa = boot_hart_probe.isa;
+		sbi_memcpy(hfeatures, &boot_hart_probe.hfeatures,
+			   sizeof(*hfeatures));
+		return;
+	}
+
+	/* Cache ISA extensions so that hot paths do not read MISA */
+	*isa = 0;
+	for (ext = 'A'; ext <= 'Z'; ext++) {
+		if (misa_extension_imp(ext))
+			*isa |= 1UL << (ext - 'A');
+	}
+
+	/* Reset hart features */
 	hfeatures->features = 0;
 	hfeatures->pmp_count = 0;
 	hfeatures->mhpm_count = 0;
@@ -428,24 +522,33 @@ __mhpm_skip:
 	csr_read_allowed(CSR_TIME, (unsigned long)&trap);
 	if (!trap.cause)
 		hfeatures->features |= SBI_HART_HAS_TIME;
-}
 
-int sbi_hart_init(struct sbi_scratch *scratch, bool cold_boot)
-{
-	int rc;
+	/* Detect if hart supports Svinval instructions */
+	if (hart_has_svinval())
+		hfeatures->features |= SBI_HART_HAS_SVINVAL;
 
-	if (cold_boot) {
-		if (misa_extension('H'))
-			sbi_hart_expected_trap = &__sbi_expected_trap_hext;
+	/* Detect if hart supports stimecmp CSR (Sstc extension) */
+	trap.cause = 0;
+	csr_read_allowed(CSR_STIMECMP, (unsigned long)&trap);
+	if (!trap.cause)
+		hfeatures->features |= SBI_HART_HAS_SSTC;
 
-		hart_features_offset = sbi_scratch_alloc_offset(
-						sizeof(struct hart_features),
-						"HART_FEATURES");
-		if (!hart_features_offset)
-			return SBI_ENOMEM;
+	/* Published to secondary HARTs when coldboot is marked done */
+	if (cold_boot) {
+		boot_hart_probe.misa = csr_read(CSR_MISA);
+		boot_hart_probe.mvendorid = csr_read(CSR_MVENDORID);
+		boot_hart_probe.marchid = csr_read(CSR_MARCHID);
+		boot_hart_probe.mimpid = csr_read(CSR_MIMPID);
+		boot_hart_probe.isa = *isa;
+		sbi_memcpy(&boot_hart_probe.hfeatures, hfeatures,
+			   sizeof(*hfeatures));
+		boot_hart_probe.valid = TRUE;
 	}
+}
 
-	hart_detect_features(scratch);
+int sbi_hart_reinit(struct sbi_scratch *scratch)
+{
+	int rc;
 
 	mstatus_init(scratch);
 
@@ -460,6 +563,29 @@ int sbi_hart_init(struct sbi_scratch *scratch, bool cold_boot)
 	return 0;
 }
 
+int sbi_hart_init(struct sbi_scratch *scratch, bool cold_boot)
+{
+	if (cold_boot) {
+		if (misa_extension('H'))
+			sbi_hart_expected_trap = &__sbi_expected_trap_hext;
+
+		hart_features_offset = sbi_scratch_alloc_offset(
+						sizeof(struct hart_features),
+						"HART_FEATURES");
+		if (!hart_features_offset)
+			return SBI_ENOMEM;
+
+		hart_isa_offset = sbi_scratch_alloc_offset(sizeof(unsigned long),
+							   "HART_ISA");
+		if (!hart_isa_offset)
+			return SBI_ENOMEM;
+	}
+
+	hart_detect_features(scratch, cold_boot);
+
+	return sbi_hart_reinit(scratch);
+}
+
 void __attribute__((noreturn)) sbi_hart_hang(void)
 {
 	while (1)
@@ -477,16 +603,17 @@ sbi_hart_switch_mode(unsigned long arg0, unsigned long arg1,
 #else
 	unsigned long val;
 #endif
+	struct sbi_scratch *scratch = sbi_scratch_thishart_ptr();
 
 	switch (next_mode) {
 	case PRV_M:
 		break;
 	case PRV_S:
-		if (!misa_extension('S'))
+		if (!sbi_hart_has_extension(scratch, 'S'))
 			sbi_hart_hang();
 		break;
 	case PRV_U:
-		if (!misa_extension('U'))
+		if (!sbi_hart_has_extension(scratch, 'U'))
 			sbi_hart_hang();
 		break;
 	default:
@@ -497,7 +624,7 @@ sbi_hart_switch_mode(unsigned long arg0, unsigned long arg1,
 	val = INSERT_FIELD(val, MSTATUS_MPP, next_mode);
 	val = INSERT_FIELD(val, MSTATUS_MPIE, 0);
 #if __riscv_xlen == 32
-	if (misa_extension('H')) {
+	if (sbi_hart_has_extension(scratch, 'H')) {
 		valH = csr_read(CSR_MSTATUSH);
 		if (next_virt)
 			valH = INSERT_FIELD(valH, MSTATUSH_MPV, 1);
@@ -506,7 +633,7 @@ sbi_hart_switch_mode(unsigned long arg0, unsigned long arg1,
 		csr_write(CSR_MSTATUSH, valH);
 	}
 #else
-	if (misa_extension('H')) {
+	if (sbi_hart_has_extension(scratch, 'H')) {
 		if (next_virt)
 			val = INSERT_FIELD(val, MSTATUS_MPV, 1);
 		else
@@ -522,7 +649,7 @@ sbi_hart_switch_mode(unsigned long arg0, unsigned long arg1,
 		csr_write(CSR_SIE, 0);
 		csr_write(CSR_SATP, 0);
 	} else if (next_mode == PRV_U) {
-		if (misa_extension('N')) {
+		if (sbi_hart_has_extension(scratch, 'N')) {
 			csr_write(CSR_UTVEC, next_addr);
 			csr_write(CSR_USCRATCH, 0);
 			csr_write(CSR_UIE, 0);
@@ -24,6 +24,7 @@
 #include <sbi/sbi_platform.h>
 #include <sbi/sbi_system.h>
 #include <sbi/sbi_timer.h>
+#include <sbi/sbi_tlb.h>
 #include <sbi/sbi_console.h>
 
 static unsigned long hart_data_offset;
@@ -31,6 +32,13 @@ static unsigned long hart_data_offset;
 /** Per hart specific data to manage state transition **/
 struct sbi_hsm_data {
 	atomic_t state;
+	/* Minimal state saved while the hart is suspended */
+	unsigned long suspend_type;
+	unsigned long saved_mie;
+	/* Resume latency (in timer ticks) */
+	u64 resume_start;
+	u64 resume_latency_last;
+	u64 resume_latency_max;
 };
 
 int sbi_hsm_hart_state_to_status(int state)
@@ -50,6 +58,15 @@ int sbi_hsm_hart_state_to_status(int state)
 	case SBI_HART_STARTED:
 		ret = SBI_HSM_HART_STATUS_STARTED;
 		break;
+	case SBI_HART_SUSPENDING:
+		ret = SBI_HSM_HART_STATUS_SUSPEND_PENDING;
+		break;
+	case SBI_HART_SUSPENDED:
+		ret = SBI_HSM_HART_STATUS_SUSPENDED;
+		break;
+	case SBI_HART_RESUMING:
+		ret = SBI_HSM_HART_STATUS_RESUME_PENDING;
+		break;
 	default:
 		ret = SBI_EINVAL;
 	}
@@ -86,16 +103,28 @@ static bool sbi_hsm_hart_started(const struct sbi_domain *dom, u32 hartid)
 		return FALSE;
 }
 
-/**
- * Get ulong HART mask for given HART base ID
- * @param dom the domain to be used for output HART mask
- * @param hbase the HART base ID
- * @param out_hmask the output ulong HART mask
- * @return 0 on success and SBI_Exxx (< 0) on failure
- * Note: the output HART mask will be set to zero on failure as well.
- */
-int sbi_hsm_hart_started_mask(const struct sbi_domain *dom,
-			      ulong hbase, ulong *out_hmask)
+static bool hart_state_started(int state)
+{
+	return (state == SBI_HART_STARTED) ? TRUE : FALSE;
+}
+
+/* Suspended harts still take interrupts (e.g. to wake them up) */
+static bool hart_state_interruptible(int state)
+{
+	switch (state) {
+	case SBI_HART_STARTED:
+	case SBI_HART_SUSPENDING:
+	case SBI_HART_SUSPENDED:
+	case SBI_HART_RESUMING:
+		return TRUE;
+	default:
+		return FALSE;
+	}
+}
+
+static int __sbi_hsm_hart_mask(const struct sbi_domain *dom,
+			       ulong hbase, ulong *out_hmask,
+			       bool (*match)(int state))
 {
 	ulong i, hmask, dmask;
 	ulong hend = sbi_scratch_last_hartid() + 1;
@@ -109,14 +138,42 @@ int sbi_hsm_hart_started_mask(const struct sbi_domain *dom,
 	dmask = sbi_domain_get_assigned_hartmask(dom, hbase);
 	for (i = hbase; i < hend; i++) {
 		hmask = 1UL << (i - hbase);
-		if ((dmask & hmask) &&
-		    (__sbi_hsm_hart_get_state(i) == SBI_HART_STARTED))
+		if ((dmask & hmask) && match(__sbi_hsm_hart_get_state(i)))
 			*out_hmask |= hmask;
 	}
 
 	return 0;
 }
 
+/**
+ * Get ulong HART mask for given HART base ID
+ * @param dom the domain to be used for output HART mask
+ * @param hbase the HART base ID
+ * @param out_hmask the output ulong HART mask
+ * @return 0 on success and SBI_Exxx (< 0) on failure
+ * Note: the output HART mask will be set to zero on failure as well.
+ */
+int sbi_hsm_hart_started_mask(const struct sbi_domain *dom,
+			      ulong hbase, ulong *out_hmask)
+{
+	return __sbi_hsm_hart_mask(dom, hbase, out_hmask, hart_state_started);
+}
+
+/**
+ * Get ulong HART mask of started or suspended HARTs for given HART base ID
+ * @param dom the domain to be used for output HART mask
+ * @param hbase the HART base ID
+ * @param out_hmask the output ulong HART mask
+ * @return 0 on success and SBI_Exxx (< 0) on failure
+ * Note: the output HART mask will be set to zero on failure as well.
+ */
+int sbi_hsm_hart_interruptible_mask(const struct sbi_domain *dom,
+				    ulong hbase, ulong *out_hmask)
+{
+	return __sbi_hsm_hart_mask(dom, hbase, out_hmask,
+				   hart_state_interruptible);
+}
+
 void sbi_hsm_prepare_next_jump(struct sbi_scratch *scratch, u32 hartid)
 {
 	u32 oldstate;
@@ -289,3 +346,156 @@ int sbi_hsm_hart_stop(struct sbi_scratch *scratch, bool exitnow)
 
 	return 0;
 }
+
+static int hsm_suspend_type_check(const struct sbi_platform *plat,
+				  u32 suspend_type)
+{
+	if (suspend_type == SBI_HSM_SUSPEND_RET_DEFAULT ||
+	    suspend_type == SBI_HSM_SUSPEND_NON_RET_DEFAULT)
+		return 0;
+
+	if ((SBI_HSM_SUSPEND_RET_PLATFORM <= suspend_type &&
+	     suspend_type <= SBI_HSM_SUSPEND_RET_LAST) ||
+	    (SBI_HSM_SUSPEND_NON_RET_PLATFORM <= suspend_type &&
+	     suspend_type <= SBI_HSM_SUSPEND_NON_RET_LAST)) {
+		if (plat && sbi_platform_ops(plat)->hart_suspend)
+			return 0;
+	}
+
+	return SBI_EINVAL;
+}
+
+void sbi_hsm_hart_resume_start(struct sbi_scratch *scratch)
+{
+	int oldstate;
+	struct sbi_hsm_data *hdata = sbi_scratch_offset_ptr(scratch,
+							    hart_data_offset);
+
+	hdata->resume_start = sbi_timer_value();
+
+	oldstate = atomic_cmpxchg(&hdata->state, SBI_HART_SUSPENDED,
+				  SBI_HART_RESUMING);
+	if (oldstate != SBI_HART_SUSPENDED) {
+		sbi_printf("%s: ERR: The hart is in invalid state [%u]\n",
+			   __func__, oldstate);
+		sbi_hart_hang();
+	}
+}
+
+void sbi_hsm_hart_resume_finish(struct sbi_scratch *scratch)
+{
+	int oldstate;
+	u64 latency;
+	struct sbi_hsm_data *hdata = sbi_scratch_offset_ptr(scratch,
+							    hart_data_offset);
+
+	/* Restore MIE CSR */
+	csr_write(CSR_MIE, hdata->saved_mie);
+
+	/* Flush whatever was deferred to us while we were suspended */
+	sbi_tlb_idle_exit(scratch);
+
+	latency = sbi_timer_value() - hdata->resume_start;
+	hdata->resume_latency_last = latency;
+	if (latency > hdata->resume_latency_max)
+		hdata->resume_latency_max = latency;
+
+	oldstate = atomic_cmpxchg(&hdata->state, SBI_HART_RESUMING,
+				  SBI_HART_STARTED);
+	if (oldstate != SBI_HART_RESUMING) {
+		sbi_printf("%s: ERR: The hart is in invalid state [%u]\n",
+			   __func__, oldstate);
+		sbi_hart_hang();
+	}
+}
+
+/**
+ * Get the firmware resume latency of a HART in timer ticks
+ * @param scratch the scratch space of the HART
+ * @param last latency of the most recent resume (optional)
+ * @param max largest latency seen so far (optional)
+ */
+void sbi_hsm_hart_resume_latency(struct sbi_scratch *scratch,
+				 u64 *last, u64 *max)
+{
+	struct sbi_hsm_data *hdata = sbi_scratch_offset_ptr(scratch,
+							    hart_data_offset);
+
+	if (last)
+		*last = hdata->resume_latency_last;
+	if (max)
+		*max = hdata->resume_latency_max;
+}
+
+int sbi_hsm_hart_suspend(struct sbi_scratch *scratch, u32 suspend_type,
+			 ulong raddr, ulong rmode, ulong priv)
+{
+	int oldstate, ret;
+	const struct sbi_domain *dom = sbi_domain_thishart_ptr();
+	const struct sbi_platform *plat = sbi_platform_ptr(scratch);
+	struct sbi_hsm_data *hdata = sbi_scratch_offset_ptr(scratch,
+							    hart_data_offset);
+
+	ret = hsm_suspend_type_check(plat, suspend_type);
+	if (ret)
+		return ret;
+
+	if (suspend_type & SBI_HSM_SUSPEND_NON_RET_BIT) {
+		/* We only allow resume mode to be S-mode or U-mode. */
+		if (rmode != PRV_S && rmode != PRV_U)
+			return SBI_EINVAL;
+		if (dom && !sbi_domain_check_addr(dom, raddr, rmode,
+						  SBI_DOMAIN_EXECUTE))
+			return SBI_EINVALID_ADDR;
+	}
+
+	oldstate = atomic_cmpxchg(&hdata->state, SBI_HART_STARTED,
+				  SBI_HART_SUSPENDING);
+	if (oldstate != SBI_HART_STARTED) {
+		sbi_printf("%s: ERR: The hart is in invalid state [%u]\n",
+			   __func__, oldstate);
+		return SBI_EDENIED;
+	}
+
+	hdata->suspend_type = suspend_type;
+	hdata->saved_mie = csr_read(CSR_MIE);
+
+	/* Where to go when the hart loses its state */
+	if (suspend_type & SBI_HSM_SUSPEND_NON_RET_BIT) {
+		scratch->next_arg1 = priv;
+		scratch->next_addr = raddr;
+		scratch->next_mode = rmode;
+	}
+
+	/* IPIs must be able to wake us up */
+	csr_set(CSR_MIE, MIP_MSIP);
+
+	/* Remote TLB flushes are deferred until we resume */
+	sbi_tlb_idle_enter(scratch);
+
+	atomic_write(&hdata->state, SBI_HART_SUSPENDED);
+
+	if (suspend_type == SBI_HSM_SUSPEND_RET_DEFAULT ||
+	    suspend_type == SBI_HSM_SUSPEND_NON_RET_DEFAULT)
+		wfi();
+	else
+		ret = sbi_platform_hart_suspend(plat, suspend_type,
+						scratch->warmboot_addr);
+
+	/*
+	 * Getting here means the hart state was retained, either because
+	 * the suspend type is retentive or the platform backed out of it.
+	 */
+	sbi_hsm_hart_resume_start(scratch);
+	sbi_hsm_hart_resume_finish(scratch);
+
+	if (ret)
+		return ret;
+
+	if (suspend_type & SBI_HSM_SUSPEND_NON_RET_BIT)
+		sbi_hart_switch_mode(current_hartid(), scratch->next_arg1,
+				     scratch->next_addr, scratch->next_mode,
+				     FALSE);
+
+	return 0;
+}
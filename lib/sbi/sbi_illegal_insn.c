@@ -13,6 +13,8 @@
 #include <sbi/sbi_emulate_csr.h>
 #include <sbi/sbi_error.h>
 #include <sbi/sbi_illegal_insn.h>
+#include <sbi/sbi_scratch.h>
+#include <sbi/sbi_tlb.h>
 #include <sbi/sbi_trap.h>
 #include <sbi/sbi_unpriv.h>
 
@@ -31,6 +33,50 @@ static int truly_illegal_insn(ulong insn, struct sbi_trap_regs *regs)
 	return sbi_trap_redirect(regs, &trap);
 }
 
+static int wfi_insn(ulong insn, struct sbi_trap_regs *regs)
+{
+	ulong prev_mode = (regs->mstatus & MSTATUS_MPP) >> MSTATUS_MPP_SHIFT;
+	struct sbi_scratch *scratch = sbi_scratch_thishart_ptr();
+#if __riscv_xlen == 32
+	bool prev_virt = (regs->mstatusH & MSTATUSH_MPV) ? TRUE : FALSE;
+#else
+	bool prev_virt = (regs->mstatus & MSTATUS_MPV) ? TRUE : FALSE;
+#endif
+
+	/* Only (virtual) supervisor WFI is trapped on purpose (MSTATUS.TW) */
+	if (prev_mode != PRV_S)
+		return truly_illegal_insn(insn, regs);
+
+	/*
+	 * MSTATUS.TW takes precedence over HSTATUS.VTW, so give the
+	 * hypervisor the virtual instruction trap it asked for.
+	 */
+	if (prev_virt && (csr_read(CSR_HSTATUS) & HSTATUS_VTW)) {
+		struct sbi_trap_info trap;
+
+		trap.epc = regs->mepc;
+		trap.cause = CAUSE_VIRTUAL_INST_FAULT;
+		trap.tval = insn;
+		trap.tval2 = 0;
+		trap.tinst = 0;
+
+		return sbi_trap_redirect(regs, &trap);
+	}
+
+	/*
+	 * WFI in M-mode wakes up on the same locally enabled interrupts
+	 * as it would have in S-mode, so the HART can be marked idle for
+	 * the duration of the wait.
+	 */
+	sbi_tlb_idle_enter(scratch);
+	wfi();
+	sbi_tlb_idle_exit(scratch);
+
+	regs->mepc += 4;
+
+	return 0;
+}
+
 static int system_opcode_insn(ulong insn, struct sbi_trap_regs *regs)
 {
 	int do_write, rs1_num = (insn >> 15) & 0x1f;
@@ -38,6 +84,9 @@ static int system_opcode_insn(ulong insn, struct sbi_trap_regs *regs)
 	int csr_num   = (u32)insn >> 20;
 	ulong csr_val, new_csr_val;
 
+	if ((insn & INSN_MASK_WFI) == INSN_MATCH_WFI)
+		return wfi_insn(insn, regs);
+
 	/* TODO: Ensure that we got CSR read/write instruction */
 
 	if (sbi_emulate_csr_read(csr_num, regs, &csr_val))
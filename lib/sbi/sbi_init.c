@@ -10,7 +10,7 @@
 #include <sbi/riscv_asm.h>
 #include <sbi/riscv_atomic.h>
 #include <sbi/riscv_barrier.h>
-#include <sbi/riscv_locks.h>
+#include <sbi/sbi_boot_profile.h>
 #include <sbi/sbi_console.h>
 #include <sbi/sbi_domain.h>
 #include <sbi/sbi_ecall.h>
@@ -122,7 +122,25 @@ static void sbi_boot_print_hart(struct sbi_scratch *scratch, u32 hartid)
 	sbi_hart_delegation_dump(scratch, "Boot HART ", "         ");
 }
 
-static spinlock_t coldboot_lock = SPIN_LOCK_INITIALIZER;
+static void sbi_boot_print_tlb(struct sbi_scratch *scratch)
+{
+	bool calibrated;
+	unsigned long limit;
+
+	if (scratch->options & SBI_SCRATCH_NO_BOOT_PRINTS)
+		return;
+
+	limit = sbi_tlb_range_flush_limit(&calibrated);
+	sbi_printf("TLB Range Flush Limit     : %lu bytes%s\n",
+		   limit, (calibrated) ? " (calibrated)" : "");
+}
+
+/*
+ * Secondary HARTs announce themselves in coldboot_wait_hmask without
+ * taking any lock. The coldboot HART claims a whole word of waiting
+ * HARTs with one AMO and sends an IPI only to the HARTs it claimed, so
+ * a waiter which clears its own bit knows that no IPI is on the way.
+ */
 static struct sbi_hartmask coldboot_wait_hmask = { 0 };
 
 static unsigned long coldboot_done;
@@ -130,22 +148,20 @@ static unsigned long coldboot_done;
 static void wait_for_coldboot(struct sbi_scratch *scratch, u32 hartid)
 {
 	unsigned long saved_mie, cmip;
+	volatile unsigned long *bits = coldboot_wait_hmask.bits;
 	const struct sbi_platform *plat = sbi_platform_ptr(scratch);
 
+	if (SBI_HARTMASK_MAX_BITS <= hartid)
+		sbi_hart_hang();
+
 	/* Save MIE CSR */
 	saved_mie = csr_read(CSR_MIE);
 
 	/* Set MSIE bit to receive IPI */
 	csr_set(CSR_MIE, MIP_MSIP);
 
-	/* Acquire coldboot lock */
-	spin_lock(&coldboot_lock);
-
-	/* Mark current HART as waiting */
-	sbi_hartmask_set_hart(hartid, &coldboot_wait_hmask);
-
-	/* Release coldboot lock */
-	spin_unlock(&coldboot_lock);
+	/* Mark current HART as waiting (fully ordered AMO) */
+	atomic_raw_test_and_set_bit(hartid, bits);
 
 	/* Wait for coldboot to finish using WFI */
 	while (!__smp_load_acquire(&coldboot_done)) {
@@ -155,14 +171,16 @@ static void wait_for_coldboot(struct sbi_scratch *scratch, u32 hartid)
 		 } while (!(cmip & MIP_MSIP));
 	};
 
-	/* Acquire coldboot lock */
-	spin_lock(&coldboot_lock);
-
-	/* Unmark current HART as waiting */
-	sbi_hartmask_clear_hart(hartid, &coldboot_wait_hmask);
-
-	/* Release coldboot lock */
-	spin_unlock(&coldboot_lock);
+	/*
+	 * Unmark current HART as waiting. If the coldboot HART got to
+	 * our bit first then an IPI is (or will soon be) pending which
+	 * has to be consumed before going further.
+	 */
+	if (!(atomic_raw_test_and_clear_bit(hartid, bits) &
+	      BIT_MASK(hartid))) {
+		while (!(csr_read(CSR_MIP) & MIP_MSIP))
+			wfi();
+	}
 
 	/* Restore MIE CSR */
 	csr_write(CSR_MIE, saved_mie);
@@ -173,23 +191,32 @@ static void wait_for_coldboot(struct sbi_scratch *scratch, u32 hartid)
 
 static void wake_coldboot_harts(struct sbi_scratch *scratch, u32 hartid)
 {
+	u32 i, last_hartid = sbi_scratch_last_hartid();
+	unsigned long w, m, hbase;
 	const struct sbi_platform *plat = sbi_platform_ptr(scratch);
 
 	/* Mark coldboot done */
 	__smp_store_release(&coldboot_done, 1);
 
-	/* Acquire coldboot lock */
-	spin_lock(&coldboot_lock);
+	/* Order the store above against reading the waiting HARTs */
+	smp_mb();
 
 	/* Send an IPI to all HARTs waiting for coldboot */
-	for (int i = 0; i <= sbi_scratch_last_hartid(); i++) {
-		if ((i != hartid) &&
-		    sbi_hartmask_test_hart(i, &coldboot_wait_hmask))
-			sbi_platform_ipi_send(plat, i);
+	for (w = 0; w < BITS_TO_LONGS(SBI_HARTMASK_MAX_BITS); w++) {
+		hbase = w * BITS_PER_LONG;
+		if (last_hartid < hbase)
+			break;
+		if (!coldboot_wait_hmask.bits[w])
+			continue;
+
+		m = atomic_raw_xchg_ulong(&coldboot_wait_hmask.bits[w], 0);
+		while (m) {
+			i = hbase + __ffs(m);
+			m &= m - 1;
+			if (i != hartid)
+				sbi_platform_ipi_send(plat, i);
+		}
 	}
-
-	/* Release coldboot lock */
-	spin_unlock(&coldboot_lock);
 }
 
 static unsigned long init_count_offset;
@@ -199,16 +226,24 @@ static void __noreturn init_coldboot(struct sbi_scratch *scratch, u32 hartid)
 	int rc;
 	unsigned long *init_count;
 	const struct sbi_platform *plat = sbi_platform_ptr(scratch);
+	u64 entry_cycle = sbi_boot_profile_cycle();
 
 	/* Note: This has to be first thing in coldboot init sequence */
 	rc = sbi_scratch_init(scratch);
 	if (rc)
 		sbi_hart_hang();
 
+	/* Note: Boot profiler only needs scratch space allocation */
+	rc = sbi_boot_profile_init(scratch, TRUE, entry_cycle);
+	if (rc)
+		sbi_hart_hang();
+	sbi_boot_profile_mark(scratch, SBI_BOOT_STAGE_SCRATCH);
+
 	/* Note: This has to be second thing in coldboot init sequence */
 	rc = sbi_domain_init(scratch, hartid);
 	if (rc)
 		sbi_hart_hang();
+	sbi_boot_profile_mark(scratch, SBI_BOOT_STAGE_DOMAIN);
 
 	init_count_offset = sbi_scratch_alloc_offset(__SIZEOF_POINTER__,
 						     "INIT_COUNT");
@@ -218,20 +253,25 @@ static void __noreturn init_coldboot(struct sbi_scratch *scratch, u32 hartid)
 	rc = sbi_hsm_init(scratch, hartid, TRUE);
 	if (rc)
 		sbi_hart_hang();
+	sbi_boot_profile_mark(scratch, SBI_BOOT_STAGE_HSM);
 
 	rc = sbi_platform_early_init(plat, TRUE);
 	if (rc)
 		sbi_hart_hang();
+	sbi_boot_profile_mark(scratch, SBI_BOOT_STAGE_PLATFORM_EARLY);
 
 	rc = sbi_hart_init(scratch, TRUE);
 	if (rc)
 		sbi_hart_hang();
+	sbi_boot_profile_mark(scratch, SBI_BOOT_STAGE_HART);
 
 	rc = sbi_console_init(scratch);
 	if (rc)
 		sbi_hart_hang();
+	sbi_boot_profile_mark(scratch, SBI_BOOT_STAGE_CONSOLE);
 
 	sbi_boot_print_banner(scratch);
+	sbi_boot_profile_mark(scratch, SBI_BOOT_STAGE_BANNER);
 
 	rc = sbi_platform_irqchip_init(plat, TRUE);
 	if (rc) {
@@ -239,32 +279,38 @@ static void __noreturn init_coldboot(struct sbi_scratch *scratch, u32 hartid)
 			   __func__, rc);
 		sbi_hart_hang();
 	}
+	sbi_boot_profile_mark(scratch, SBI_BOOT_STAGE_IRQCHIP);
 
 	rc = sbi_ipi_init(scratch, TRUE);
 	if (rc) {
 		sbi_printf("%s: ipi init failed (error %d)\n", __func__, rc);
 		sbi_hart_hang();
 	}
+	sbi_boot_profile_mark(scratch, SBI_BOOT_STAGE_IPI);
 
 	rc = sbi_tlb_init(scratch, TRUE);
 	if (rc) {
 		sbi_printf("%s: tlb init failed (error %d)\n", __func__, rc);
 		sbi_hart_hang();
 	}
+	sbi_boot_profile_mark(scratch, SBI_BOOT_STAGE_TLB);
 
 	rc = sbi_timer_init(scratch, TRUE);
 	if (rc) {
 		sbi_printf("%s: timer init failed (error %d)\n", __func__, rc);
 		sbi_hart_hang();
 	}
+	sbi_boot_profile_mark(scratch, SBI_BOOT_STAGE_TIMER);
 
 	rc = sbi_ecall_init();
 	if (rc) {
 		sbi_printf("%s: ecall init failed (error %d)\n", __func__, rc);
 		sbi_hart_hang();
 	}
+	sbi_boot_profile_mark(scratch, SBI_BOOT_STAGE_ECALL);
 
 	sbi_boot_print_general(scratch);
+	sbi_boot_profile_mark(scratch, SBI_BOOT_STAGE_GENERAL_INFO);
 
 	/*
 	 * Note: Finalize domains after HSM initialization so that we
@@ -278,8 +324,10 @@ static void __noreturn init_coldboot(struct sbi_scratch *scratch, u32 hartid)
 			   __func__, rc);
 		sbi_hart_hang();
 	}
+	sbi_boot_profile_mark(scratch, SBI_BOOT_STAGE_DOMAIN_FINALIZE);
 
 	sbi_boot_print_domains(scratch);
+	sbi_boot_profile_mark(scratch, SBI_BOOT_STAGE_DOMAIN_INFO);
 
 	rc = sbi_hart_pmp_configure(scratch);
 	if (rc) {
@@ -287,6 +335,7 @@ static void __noreturn init_coldboot(struct sbi_scratch *scratch, u32 hartid)
 			   __func__, rc);
 		sbi_hart_hang();
 	}
+	sbi_boot_profile_mark(scratch, SBI_BOOT_STAGE_PMP);
 
 	/*
 	 * Note: Platform final initialization should be last so that
@@ -298,8 +347,13 @@ static void __noreturn init_coldboot(struct sbi_scratch *scratch, u32 hartid)
 			   __func__, rc);
 		sbi_hart_hang();
 	}
+	sbi_boot_profile_mark(scratch, SBI_BOOT_STAGE_PLATFORM_FINAL);
 
 	sbi_boot_print_hart(scratch, hartid);
+	sbi_boot_print_tlb(scratch);
+	sbi_boot_profile_mark(scratch, SBI_BOOT_STAGE_HART_INFO);
+
+	sbi_boot_profile_dump(scratch);
 
 	wake_coldboot_harts(scratch, hartid);
 
@@ -311,52 +365,111 @@ static void __noreturn init_coldboot(struct sbi_scratch *scratch, u32 hartid)
 			     scratch->next_mode, FALSE);
 }
 
-static void __noreturn init_warmboot(struct sbi_scratch *scratch, u32 hartid)
+static void __noreturn init_warm_resume(struct sbi_scratch *scratch,
+					u32 hartid)
 {
 	int rc;
+
+	sbi_hsm_hart_resume_start(scratch);
+
+	/*
+	 * The HART lost its CSR state in a non-retentive suspend but
+	 * everything kept in scratch space is still valid so only the
+	 * CSRs need to be restored.
+	 */
+	rc = sbi_hart_reinit(scratch);
+	if (rc)
+		sbi_hart_hang();
+
+	rc = sbi_hart_pmp_configure(scratch);
+	if (rc)
+		sbi_hart_hang();
+
+	sbi_hsm_hart_resume_finish(scratch);
+
+	/*
+	 * The IPI which woke us up is still pending so handle it (along
+	 * with anything else queued for us) before leaving M-mode.
+	 */
+	sbi_ipi_process();
+
+	sbi_hart_switch_mode(hartid, scratch->next_arg1, scratch->next_addr,
+			     scratch->next_mode, FALSE);
+}
+
+static void __noreturn init_warmboot(struct sbi_scratch *scratch, u32 hartid)
+{
+	int rc, hstate;
 	unsigned long *init_count;
 	const struct sbi_platform *plat = sbi_platform_ptr(scratch);
+	u64 entry_cycle = sbi_boot_profile_cycle();
+
+	/*
+	 * A HART resuming from non-retentive suspend comes back long after
+	 * coldboot so it must not go through wait_for_coldboot() which
+	 * would consume the IPI that woke it up.
+	 */
+	if (__smp_load_acquire(&coldboot_done) && init_count_offset) {
+		hstate = sbi_hsm_hart_get_state(sbi_domain_thishart_ptr(),
+						hartid);
+		if (hstate == SBI_HART_SUSPENDED)
+			init_warm_resume(scratch, hartid);
+	}
 
 	wait_for_coldboot(scratch, hartid);
 
 	if (!init_count_offset)
 		sbi_hart_hang();
 
+	rc = sbi_boot_profile_init(scratch, FALSE, entry_cycle);
+	if (rc)
+		sbi_hart_hang();
+	sbi_boot_profile_mark(scratch, SBI_BOOT_STAGE_COLDBOOT_WAIT);
+
 	rc = sbi_hsm_init(scratch, hartid, FALSE);
 	if (rc)
 		sbi_hart_hang();
+	sbi_boot_profile_mark(scratch, SBI_BOOT_STAGE_HSM);
 
 	rc = sbi_platform_early_init(plat, FALSE);
 	if (rc)
 		sbi_hart_hang();
+	sbi_boot_profile_mark(scratch, SBI_BOOT_STAGE_PLATFORM_EARLY);
 
 	rc = sbi_hart_init(scratch, FALSE);
 	if (rc)
 		sbi_hart_hang();
+	sbi_boot_profile_mark(scratch, SBI_BOOT_STAGE_HART);
 
 	rc = sbi_platform_irqchip_init(plat, FALSE);
 	if (rc)
 		sbi_hart_hang();
+	sbi_boot_profile_mark(scratch, SBI_BOOT_STAGE_IRQCHIP);
 
 	rc = sbi_ipi_init(scratch, FALSE);
 	if (rc)
 		sbi_hart_hang();
+	sbi_boot_profile_mark(scratch, SBI_BOOT_STAGE_IPI);
 
 	rc = sbi_tlb_init(scratch, FALSE);
 	if (rc)
 		sbi_hart_hang();
+	sbi_boot_profile_mark(scratch, SBI_BOOT_STAGE_TLB);
 
 	rc = sbi_timer_init(scratch, FALSE);
 	if (rc)
 		sbi_hart_hang();
+	sbi_boot_profile_mark(scratch, SBI_BOOT_STAGE_TIMER);
 
 	rc = sbi_hart_pmp_configure(scratch);
 	if (rc)
 		sbi_hart_hang();
+	sbi_boot_profile_mark(scratch, SBI_BOOT_STAGE_PMP);
 
 	rc = sbi_platform_final_init(plat, FALSE);
 	if (rc)
 		sbi_hart_hang();
+	sbi_boot_profile_mark(scratch, SBI_BOOT_STAGE_PLATFORM_FINAL);
 
 	init_count = sbi_scratch_offset_ptr(scratch, init_count_offset);
 	(*init_count)++;
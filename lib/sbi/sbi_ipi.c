@@ -22,25 +22,28 @@
 
 struct sbi_ipi_data {
 	unsigned long ipi_type;
+	/* Doorbells rung by this HART */
+	unsigned long doorbell_count;
+	/* Doorbells skipped by this HART as target already had IPI pending */
+	unsigned long doorbell_suppressed;
 };
 
 static unsigned long ipi_data_off;
 
 static const struct sbi_ipi_event_ops *ipi_ops_array[SBI_IPI_EVENT_MAX];
 
-static int sbi_ipi_send(struct sbi_scratch *scratch, u32 remote_hartid,
-			u32 event, void *data)
+/*
+ * Returns 0 if the doorbell of remote HART must be rung, 1 if remote HART
+ * already had an IPI pending which will also pick up this event, or a
+ * negative error code.
+ */
+static int sbi_ipi_update(struct sbi_scratch *scratch, u32 remote_hartid,
+			  u32 event, void *data)
 {
 	int ret;
 	struct sbi_scratch *remote_scratch = NULL;
-	const struct sbi_platform *plat = sbi_platform_ptr(scratch);
 	struct sbi_ipi_data *ipi_data;
-	const struct sbi_ipi_event_ops *ipi_ops;
-
-	if ((SBI_IPI_EVENT_MAX <= event) ||
-	    !ipi_ops_array[event])
-		return SBI_EINVAL;
-	ipi_ops = ipi_ops_array[event];
+	const struct sbi_ipi_event_ops *ipi_ops = ipi_ops_array[event];
 
 	remote_scratch = sbi_hartid_to_scratch(remote_hartid);
 	if (!remote_scratch)
@@ -56,54 +59,112 @@ static int sbi_ipi_send(struct sbi_scratch *scratch, u32 remote_hartid,
 	}
 
 	/*
-	 * Set IPI type on remote hart's scratch area and
-	 * trigger the interrupt
+	 * Set IPI type on remote hart's scratch area. The remote HART clears
+	 * its doorbell before it atomically takes all pending IPI types, so
+	 * a doorbell is only needed on the empty to non-empty transition.
 	 */
-	atomic_raw_set_bit(event, &ipi_data->ipi_type);
-	smp_wmb();
-	sbi_platform_ipi_send(plat, remote_hartid);
+	if (atomic_raw_test_and_set_bit(event, &ipi_data->ipi_type))
+		return 1;
+
+	return 0;
+}
+
+/*
+ * Update all target HARTs of one hartmask window and then trigger their
+ * interrupts in a single platform call. Returns the number of targets
+ * which received the event, including those whose doorbell was suppressed.
+ * Events with a per-target sync callback are sent and synced one target
+ * at a time instead.
+ */
+static ulong sbi_ipi_send_window(struct sbi_scratch *scratch,
+				 ulong m, ulong hbase, u32 event, void *data)
+{
+	int rc;
+	ulong i, j, sent = 0, rmask = 0;
+	const struct sbi_ipi_event_ops *ipi_ops = ipi_ops_array[event];
+	struct sbi_ipi_data *ipi_data =
+			sbi_scratch_offset_ptr(scratch, ipi_data_off);
+
+	for (i = hbase, j = 0; m; i++, j++, m >>= 1) {
+		if (!(m & 1UL))
+			continue;
+
+		rc = sbi_ipi_update(scratch, i, event, data);
+		if (rc < 0)
+			continue;
 
-	if (ipi_ops->sync)
+		if (!rc)
+			ipi_data->doorbell_count++;
+		else
+			ipi_data->doorbell_suppressed++;
+		sent++;
+
+		if (!ipi_ops->sync) {
+			if (!rc)
+				rmask |= 1UL << j;
+			continue;
+		}
+
+		if (!rc)
+			sbi_platform_ipi_send(sbi_platform_ptr(scratch), i);
 		ipi_ops->sync(scratch);
+	}
 
-	return 0;
+	/* Drivers order the updates above before their doorbell writes */
+	if (rmask)
+		sbi_platform_ipi_send_mask(sbi_platform_ptr(scratch),
+					   rmask, hbase);
+
+	return sent;
 }
 
 /**
  * As this this function only handlers scalar values of hart mask, it must be
  * set to all online harts if the intention is to send IPIs to all the harts.
  * If hmask is zero, no IPIs will be sent.
+ *
+ * For events with a sync callback, each target HART is updated, interrupted
+ * and waited for before moving to the next one. For other events the update
+ * callback is invoked and the IPI type is set for every target HART first,
+ * all doorbells are then rung together and the sync_all callback (if any)
+ * is invoked only once so that the event can wait for all target HARTs
+ * together instead of one HART at a time.
  */
 int sbi_ipi_send_many(ulong hmask, ulong hbase, u32 event, void *data)
 {
 	int rc;
-	ulong i, m;
+	ulong m, sent = 0;
+	const struct sbi_ipi_event_ops *ipi_ops;
 	struct sbi_domain *dom = sbi_domain_thishart_ptr();
 	struct sbi_scratch *scratch = sbi_scratch_thishart_ptr();
 
+	if ((SBI_IPI_EVENT_MAX <= event) ||
+	    !ipi_ops_array[event])
+		return SBI_EINVAL;
+	ipi_ops = ipi_ops_array[event];
+
 	if (hbase != -1UL) {
-		rc = sbi_hsm_hart_started_mask(dom, hbase, &m);
+		rc = sbi_hsm_hart_interruptible_mask(dom, hbase, &m);
 		if (rc)
 			return rc;
 		m &= hmask;
 
 		/* Send IPIs */
-		for (i = hbase; m; i++, m >>= 1) {
-			if (m & 1UL)
-				sbi_ipi_send(scratch, i, event, data);
-		}
+		sent += sbi_ipi_send_window(scratch, m, hbase, event, data);
 	} else {
 		hbase = 0;
-		while (!sbi_hsm_hart_started_mask(dom, hbase, &m)) {
+		while (!sbi_hsm_hart_interruptible_mask(dom, hbase, &m)) {
 			/* Send IPIs */
-			for (i = hbase; m; i++, m >>= 1) {
-				if (m & 1UL)
-					sbi_ipi_send(scratch, i, event, data);
-			}
+			sent += sbi_ipi_send_window(scratch, m, hbase,
+						    event, data);
 			hbase += BITS_PER_LONG;
 		}
 	}
 
+	/* Wait once for all target HARTs */
+	if (sent && ipi_ops->sync_all)
+		ipi_ops->sync_all(scratch);
+
 	return 0;
 }
 
@@ -133,6 +194,22 @@ void sbi_ipi_event_destroy(u32 event)
 	ipi_ops_array[event] = NULL;
 }
 
+static int sbi_ipi_update_smode(struct sbi_scratch *scratch,
+				struct sbi_scratch *remote_scratch,
+				u32 remote_hartid, void *data)
+{
+	/*
+	 * Raise the supervisor software interrupt directly when the
+	 * platform has a device for it (such as ACLINT SSWI) so that
+	 * the target HART does not take an M-mode interrupt.
+	 */
+	if (!sbi_platform_ipi_send_smode(sbi_platform_ptr(scratch),
+					 remote_hartid))
+		return SBI_EALREADY;
+
+	return 0;
+}
+
 static void sbi_ipi_process_smode(struct sbi_scratch *scratch)
 {
 	csr_set(CSR_MIP, MIP_SSIP);
@@ -140,6 +217,7 @@ static void sbi_ipi_process_smode(struct sbi_scratch *scratch)
 
 static struct sbi_ipi_event_ops ipi_smode_ops = {
 	.name = "IPI_SMODE",
+	.update = sbi_ipi_update_smode,
 	.process = sbi_ipi_process_smode,
 };
 
@@ -172,6 +250,22 @@ int sbi_ipi_send_halt(ulong hmask, ulong hbase)
 	return sbi_ipi_send_many(hmask, hbase, ipi_halt_event, NULL);
 }
 
+unsigned long sbi_ipi_doorbell_count(struct sbi_scratch *scratch)
+{
+	struct sbi_ipi_data *ipi_data =
+			sbi_scratch_offset_ptr(scratch, ipi_data_off);
+
+	return ipi_data->doorbell_count;
+}
+
+unsigned long sbi_ipi_doorbell_suppressed_count(struct sbi_scratch *scratch)
+{
+	struct sbi_ipi_data *ipi_data =
+			sbi_scratch_offset_ptr(scratch, ipi_data_off);
+
+	return ipi_data->doorbell_suppressed;
+}
+
 void sbi_ipi_process(void)
 {
 	unsigned long ipi_type;
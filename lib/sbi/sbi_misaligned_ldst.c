@@ -21,10 +21,70 @@ union reg_data {
 	u64 data_u64;
 };
 
+/*
+ * Read len bytes one byte at a time. Used when the widened aligned loads
+ * of sbi_misaligned_read() fault so that the trap is only reported if a
+ * byte of the access itself faults, with the address of that byte.
+ */
+static int sbi_misaligned_read_bytes(ulong addr, ulong len, ulong *out,
+				     struct sbi_trap_info *uptrap)
+{
+	ulong i, val = 0;
+
+	for (i = 0; i < len; i++) {
+		val |= (ulong)sbi_load_u8((const u8 *)(addr + i), uptrap) <<
+		       (8 * i);
+		if (uptrap->cause)
+			return SBI_ETRAP;
+	}
+
+	*out = val;
+
+	return 0;
+}
+
+/*
+ * Read len (<= sizeof(ulong)) bytes from a misaligned address using at
+ * most two aligned ulong loads and merge them. The aligned words can
+ * cover bytes outside the access which may fault on their own, e.g. the
+ * other half of a doubleword protected by a PMP NA4 region, so a fault
+ * of the widened loads is retried with byte loads.
+ *
+ * Note: the widened loads also read the neighbouring bytes so this
+ * assumes regular memory. Misaligned accesses to I/O regions with read
+ * side effects are not supported.
+ */
+static int sbi_misaligned_read(ulong addr, ulong len, ulong *out,
+			       struct sbi_trap_info *uptrap)
+{
+	ulong words[2], val;
+	ulong base = addr & ~(sizeof(ulong) - 1);
+	ulong off = addr - base;
+	ulong count = ((off + len) > sizeof(ulong)) ? 2 : 1;
+
+	sbi_load_ulong_words((const ulong *)base, count, words, uptrap);
+	if (uptrap->cause) {
+		if (off || (off + len) < count * sizeof(ulong))
+			return sbi_misaligned_read_bytes(addr, len, out,
+							 uptrap);
+		return SBI_ETRAP;
+	}
+
+	val = words[0] >> (8 * off);
+	if (count == 2)
+		val |= words[1] << (8 * (sizeof(ulong) - off));
+	if (len < sizeof(ulong))
+		val &= (1UL << (8 * len)) - 1;
+
+	*out = val;
+
+	return 0;
+}
+
 int sbi_misaligned_load_handler(ulong addr, ulong tval2, ulong tinst,
 				struct sbi_trap_regs *regs)
 {
-	ulong insn, insn_len;
+	ulong insn, insn_len, tmp, chunk;
 	union reg_data val;
 	struct sbi_trap_info uptrap;
 	int i, fp = 0, shift = 0, len = 0;
@@ -118,13 +178,15 @@ int sbi_misaligned_load_handler(ulong addr, ulong tval2, ulong tinst,
 	}
 
 	val.data_u64 = 0;
-	for (i = 0; i < len; i++) {
-		val.data_bytes[i] = sbi_load_u8((void *)(addr + i),
-						&uptrap);
-		if (uptrap.cause) {
+	for (i = 0; i < len; i += sizeof(ulong)) {
+		chunk = len - i;
+		if (sizeof(ulong) < chunk)
+			chunk = sizeof(ulong);
+		if (sbi_misaligned_read(addr + i, chunk, &tmp, &uptrap)) {
 			uptrap.epc = regs->mepc;
 			return sbi_trap_redirect(regs, &uptrap);
 		}
+		val.data_u64 |= (u64)tmp << (8 * i);
 	}
 
 	if (!fp)
@@ -144,7 +206,7 @@ int sbi_misaligned_load_handler(ulong addr, ulong tval2, ulong tinst,
 int sbi_misaligned_store_handler(ulong addr, ulong tval2, ulong tinst,
 				 struct sbi_trap_regs *regs)
 {
-	ulong insn, insn_len;
+	ulong insn, insn_len, chunk;
 	union reg_data val;
 	struct sbi_trap_info uptrap;
 	int i, len = 0;
@@ -228,9 +290,18 @@ int sbi_misaligned_store_handler(ulong addr, ulong tval2, ulong tinst,
 		return sbi_trap_redirect(regs, &uptrap);
 	}
 
-	for (i = 0; i < len; i++) {
-		sbi_store_u8((void *)(addr + i), val.data_bytes[i],
-			     &uptrap);
+	/*
+	 * Stores are not merged into aligned read-modify-write accesses
+	 * because that would race with other HARTs writing the neighbouring
+	 * bytes. All bytes of a register are written in one MPRV window.
+	 */
+	for (i = 0; i < len; i += sizeof(ulong)) {
+		chunk = len - i;
+		if (sizeof(ulong) < chunk)
+			chunk = sizeof(ulong);
+		sbi_store_ulong_bytes(addr + i,
+				      (ulong)(val.data_u64 >> (8 * i)),
+				      chunk, &uptrap);
 		if (uptrap.cause) {
 			uptrap.epc = regs->mepc;
 			return sbi_trap_redirect(regs, &uptrap);
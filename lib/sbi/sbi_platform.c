@@ -31,6 +31,12 @@ static inline char *sbi_platform_feature_id2string(unsigned long feature)
 	case SBI_PLATFORM_HAS_HART_SECONDARY_BOOT:
 		fstr = "sec_boot";
 		break;
+	case SBI_PLATFORM_HAS_HOMOGENEOUS_HARTS:
+		fstr = "homogeneous";
+		break;
+	case SBI_PLATFORM_HAS_TLB_FLUSH_CALIBRATE:
+		fstr = "tlb_calib";
+		break;
 	default:
 		break;
 	}
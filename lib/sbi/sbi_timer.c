@@ -15,7 +15,20 @@
 #include <sbi/sbi_scratch.h>
 #include <sbi/sbi_timer.h>
 
+/*
+ * Per-HART min-heap of M-mode timer events ordered by deadline. The
+ * supervisor deadline is one of the events and has a reserved slot so
+ * that M-mode users can never starve S-mode of its timer.
+ */
+struct sbi_timer_queue {
+	u32 count;
+	struct sbi_timer_event supervisor;
+	struct sbi_timer_event *heap[SBI_TIMER_QUEUE_MAX_EVENTS + 1];
+};
+
 static unsigned long time_delta_off;
+static unsigned long timer_queue_off;
+unsigned long sbi_timer_fast_read_off;
 static u64 (*get_time_val)(const struct sbi_platform *plat);
 
 #if __riscv_xlen == 32
@@ -40,6 +53,11 @@ static u64 get_ticks(const struct sbi_platform *plat)
 }
 #endif
 
+bool sbi_timer_value_ready(void)
+{
+	return (get_time_val) ? TRUE : FALSE;
+}
+
 u64 sbi_timer_value(void)
 {
 	return get_time_val(sbi_platform_thishart_ptr());
@@ -78,22 +96,188 @@ void sbi_timer_set_delta_upper(ulong delta_upper)
 	*time_delta |= ((u64)delta_upper << 32);
 }
 
+void sbi_timer_set_fast_read(volatile u64 *time_val, u64 *time_delta)
+{
+	struct sbi_timer_fast_read *fast =
+		sbi_scratch_thishart_offset_ptr(sbi_timer_fast_read_off);
+
+	fast->time_delta = (unsigned long)time_delta;
+	fast->time_val = (unsigned long)time_val;
+}
+
+static void sstc_set_timecmp(u64 value)
+{
+#if __riscv_xlen == 32
+	/* Avoid a spurious timer event while updating both halves */
+	csr_write(CSR_STIMECMP, -1UL);
+	csr_write(CSR_STIMECMPH, value >> 32);
+	csr_write(CSR_STIMECMP, value & 0xffffffff);
+#else
+	csr_write(CSR_STIMECMP, value);
+#endif
+}
+
+static void timer_queue_swap(struct sbi_timer_queue *q, u32 i, u32 j)
+{
+	struct sbi_timer_event *ev = q->heap[i];
+
+	q->heap[i] = q->heap[j];
+	q->heap[j] = ev;
+	q->heap[i]->index = i;
+	q->heap[j]->index = j;
+}
+
+static void timer_queue_sift_up(struct sbi_timer_queue *q, u32 i)
+{
+	u32 parent;
+
+	while (i) {
+		parent = (i - 1) / 2;
+		if (q->heap[parent]->deadline <= q->heap[i]->deadline)
+			break;
+		timer_queue_swap(q, i, parent);
+		i = parent;
+	}
+}
+
+static void timer_queue_sift_down(struct sbi_timer_queue *q, u32 i)
+{
+	u32 l, r, min;
+
+	while (1) {
+		l = 2 * i + 1;
+		r = l + 1;
+		min = i;
+		if (l < q->count &&
+		    q->heap[l]->deadline < q->heap[min]->deadline)
+			min = l;
+		if (r < q->count &&
+		    q->heap[r]->deadline < q->heap[min]->deadline)
+			min = r;
+		if (min == i)
+			break;
+		timer_queue_swap(q, i, min);
+		i = min;
+	}
+}
+
+static void timer_queue_remove(struct sbi_timer_queue *q,
+			       struct sbi_timer_event *ev)
+{
+	u32 i = ev->index;
+
+	ev->pending = FALSE;
+	q->count--;
+	if (i == q->count)
+		return;
+
+	q->heap[i] = q->heap[q->count];
+	q->heap[i]->index = i;
+	timer_queue_sift_down(q, i);
+	timer_queue_sift_up(q, i);
+}
+
+static void timer_queue_insert(struct sbi_timer_queue *q,
+			       struct sbi_timer_event *ev, u64 deadline)
+{
+	ev->deadline = deadline;
+	ev->index = q->count;
+	ev->pending = TRUE;
+	q->heap[q->count++] = ev;
+	timer_queue_sift_up(q, ev->index);
+}
+
+/* Program the timer comparator with the earliest deadline (if any) */
+static void timer_queue_program(struct sbi_timer_queue *q)
+{
+	if (!q->count) {
+		csr_clear(CSR_MIE, MIP_MTIP);
+		return;
+	}
+
+	sbi_platform_timer_event_start(sbi_platform_thishart_ptr(),
+				       q->heap[0]->deadline);
+	csr_set(CSR_MIE, MIP_MTIP);
+}
+
+int sbi_timer_event_add(struct sbi_timer_event *ev, u64 deadline)
+{
+	struct sbi_timer_queue *q;
+
+	if (!ev || !ev->callback)
+		return SBI_EINVAL;
+
+	q = sbi_scratch_thishart_offset_ptr(timer_queue_off);
+	if (ev->pending)
+		timer_queue_remove(q, ev);
+	else if (ev != &q->supervisor &&
+		 (q->count - q->supervisor.pending) >= SBI_TIMER_QUEUE_MAX_EVENTS)
+		return SBI_ENOSPC;
+
+	timer_queue_insert(q, ev, deadline);
+	timer_queue_program(q);
+
+	return 0;
+}
+
+void sbi_timer_event_cancel(struct sbi_timer_event *ev)
+{
+	struct sbi_timer_queue *q;
+
+	if (!ev || !ev->pending)
+		return;
+
+	q = sbi_scratch_thishart_offset_ptr(timer_queue_off);
+	timer_queue_remove(q, ev);
+	timer_queue_program(q);
+}
+
+static void supervisor_timer_expired(struct sbi_timer_event *ev)
+{
+	csr_set(CSR_MIP, MIP_STIP);
+}
+
 void sbi_timer_event_start(u64 next_event)
 {
-	sbi_platform_timer_event_start(sbi_platform_thishart_ptr(), next_event);
+	struct sbi_scratch *scratch = sbi_scratch_thishart_ptr();
+	struct sbi_timer_queue *q;
+
+	/*
+	 * With Sstc the STIP bit follows STIMECMP so the timer event is
+	 * delivered to S-mode without an M-mode timer interrupt.
+	 */
+	if (sbi_hart_has_feature(scratch, SBI_HART_HAS_SSTC)) {
+		sstc_set_timecmp(next_event);
+		return;
+	}
+
+	q = sbi_scratch_offset_ptr(scratch, timer_queue_off);
 	csr_clear(CSR_MIP, MIP_STIP);
-	csr_set(CSR_MIE, MIP_MTIP);
+	sbi_timer_event_add(&q->supervisor, next_event);
 }
 
 void sbi_timer_process(void)
 {
-	csr_clear(CSR_MIE, MIP_MTIP);
-	csr_set(CSR_MIP, MIP_STIP);
+	u64 now = sbi_timer_value();
+	struct sbi_timer_event *ev;
+	struct sbi_timer_queue *q =
+			sbi_scratch_thishart_offset_ptr(timer_queue_off);
+
+	/* Dispatch all expired events before reprogramming the timer */
+	while (q->count && q->heap[0]->deadline <= now) {
+		ev = q->heap[0];
+		timer_queue_remove(q, ev);
+		ev->callback(ev);
+	}
+
+	timer_queue_program(q);
 }
 
 int sbi_timer_init(struct sbi_scratch *scratch, bool cold_boot)
 {
 	u64 *time_delta;
+	struct sbi_timer_queue *q;
+	struct sbi_timer_fast_read *fast;
 	const struct sbi_platform *plat = sbi_platform_ptr(scratch);
 	int ret;
 
@@ -102,14 +286,39 @@ int sbi_timer_init(struct sbi_scratch *scratch, bool cold_boot)
 							  "TIME_DELTA");
 		if (!time_delta_off)
 			return SBI_ENOMEM;
+		sbi_timer_fast_read_off = sbi_scratch_alloc_offset(
+							sizeof(*fast),
+							"TIME_FAST_READ");
+		if (!sbi_timer_fast_read_off) {
+			sbi_scratch_free_offset(time_delta_off);
+			return SBI_ENOMEM;
+		}
+		timer_queue_off = sbi_scratch_alloc_offset(sizeof(*q),
+							   "TIMER_QUEUE");
+		if (!timer_queue_off) {
+			sbi_scratch_free_offset(sbi_timer_fast_read_off);
+			sbi_scratch_free_offset(time_delta_off);
+			return SBI_ENOMEM;
+		}
 	} else {
-		if (!time_delta_off)
+		if (!time_delta_off || !sbi_timer_fast_read_off ||
+		    !timer_queue_off)
 			return SBI_ENOMEM;
 	}
 
+	q = sbi_scratch_offset_ptr(scratch, timer_queue_off);
+	q->count = 0;
+	q->supervisor.callback = supervisor_timer_expired;
+	q->supervisor.pending = FALSE;
+
 	time_delta = sbi_scratch_offset_ptr(scratch, time_delta_off);
 	*time_delta = 0;
 
+	/* Platform timer init may enable the fast path for this HART */
+	fast = sbi_scratch_offset_ptr(scratch, sbi_timer_fast_read_off);
+	fast->time_val = 0;
+	fast->time_delta = 0;
+
 	ret = sbi_platform_timer_init(plat, cold_boot);
 	if (ret)
 		return ret;
@@ -127,6 +336,16 @@ int sbi_timer_init(struct sbi_scratch *scratch, bool cold_boot)
 
 void sbi_timer_exit(struct sbi_scratch *scratch)
 {
+	struct sbi_timer_queue *q =
+			sbi_scratch_offset_ptr(scratch, timer_queue_off);
+
+	/* Pending M-mode timer events are dropped */
+	while (q->count)
+		timer_queue_remove(q, q->heap[q->count - 1]);
+
+	if (sbi_hart_has_feature(scratch, SBI_HART_HAS_SSTC))
+		sstc_set_timecmp(-1ULL);
+
 	sbi_platform_timer_event_stop(sbi_platform_ptr(scratch));
 
 	csr_clear(CSR_MIP, MIP_STIP);
@@ -22,16 +22,52 @@
 #include <sbi/sbi_console.h>
 #include <sbi/sbi_platform.h>
 
+/** Per-HART state used to wait for remote TLB requests */
+struct sbi_tlb_sync {
+	/** Number of remote HART acknowledgements still outstanding */
+	atomic_t pending;
+	/** Last ticket handed out for an asynchronous request */
+	unsigned long issued;
+	/** Every ticket up to (and including) this one is complete */
+	unsigned long completed;
+	/** Number of requests merged into already queued entries */
+	unsigned long coalesced;
+	/** Idle state of this HART (enum sbi_tlb_idle_state) */
+	atomic_t idle;
+};
+
+/** Idle states used to defer remote TLB requests until wake up */
+enum sbi_tlb_idle_state {
+	SBI_TLB_AWAKE = 0,
+	SBI_TLB_IDLE,
+	SBI_TLB_IDLE_FLUSH_PENDING,
+};
+
 unsigned long tlb_sync_off;
 unsigned long tlb_fifo_off;
 unsigned long tlb_fifo_mem_off;
 static unsigned long tlb_range_flush_limit;
+static bool tlb_range_flush_calibrated;
+
+/* Number of samples taken for each flush type during calibration */
+#define SBI_TLB_CALIBRATE_SAMPLES	16
 
 static void sbi_tlb_flush_all(void)
 {
 	__asm__ __volatile("sfence.vma");
 }
 
+/*
+ * With Svinval, range loops use the fine-grained invalidation instructions
+ * which are ordered only once for the whole range by a single
+ * SFENCE.W.INVAL and SFENCE.INVAL.IR pair instead of once per page.
+ */
+static inline bool sbi_tlb_has_svinval(void)
+{
+	return sbi_hart_has_feature(sbi_scratch_thishart_ptr(),
+				    SBI_HART_HAS_SVINVAL);
+}
+
 static void sbi_tlb_hfence_vvma(struct sbi_tlb_info *tinfo)
 {
 	unsigned long start = tinfo->start;
@@ -47,6 +83,14 @@ static void sbi_tlb_hfence_vvma(struct sbi_tlb_info *tinfo)
 		goto done;
 	}
 
+	if (sbi_tlb_has_svinval()) {
+		__sbi_sfence_w_inval();
+		for (i = 0; i < size; i += PAGE_SIZE)
+			__sbi_hinval_vvma_va(start + i);
+		__sbi_sfence_inval_ir();
+		goto done;
+	}
+
 	for (i = 0; i < size; i += PAGE_SIZE) {
 		__sbi_hfence_vvma_va(start+i);
 	}
@@ -66,6 +110,14 @@ static void sbi_tlb_hfence_gvma(struct sbi_tlb_info *tinfo)
 		return;
 	}
 
+	if (sbi_tlb_has_svinval()) {
+		__sbi_sfence_w_inval();
+		for (i = 0; i < size; i += PAGE_SIZE)
+			__sbi_hinval_gvma_gpa(start + i);
+		__sbi_sfence_inval_ir();
+		return;
+	}
+
 	for (i = 0; i < size; i += PAGE_SIZE) {
 		__sbi_hfence_gvma_gpa(start+i);
 	}
@@ -82,6 +134,14 @@ static void sbi_tlb_sfence_vma(struct sbi_tlb_info *tinfo)
 		return;
 	}
 
+	if (sbi_tlb_has_svinval()) {
+		__sbi_sfence_w_inval();
+		for (i = 0; i < size; i += PAGE_SIZE)
+			__sbi_sinval_vma_va(start + i);
+		__sbi_sfence_inval_ir();
+		return;
+	}
+
 	for (i = 0; i < size; i += PAGE_SIZE) {
 		__asm__ __volatile__("sfence.vma %0"
 				     :
@@ -111,6 +171,14 @@ static void sbi_tlb_hfence_vvma_asid(struct sbi_tlb_info *tinfo)
 		goto done;
 	}
 
+	if (sbi_tlb_has_svinval()) {
+		__sbi_sfence_w_inval();
+		for (i = 0; i < size; i += PAGE_SIZE)
+			__sbi_hinval_vvma_asid_va(start + i, asid);
+		__sbi_sfence_inval_ir();
+		goto done;
+	}
+
 	for (i = 0; i < size; i += PAGE_SIZE) {
 		__sbi_hfence_vvma_asid_va(start + i, asid);
 	}
@@ -136,6 +204,14 @@ static void sbi_tlb_hfence_gvma_vmid(struct sbi_tlb_info *tinfo)
 		return;
 	}
 
+	if (sbi_tlb_has_svinval()) {
+		__sbi_sfence_w_inval();
+		for (i = 0; i < size; i += PAGE_SIZE)
+			__sbi_hinval_gvma_vmid_gpa(start + i, vmid);
+		__sbi_sfence_inval_ir();
+		return;
+	}
+
 	for (i = 0; i < size; i += PAGE_SIZE) {
 		__sbi_hfence_gvma_vmid_gpa(start + i, vmid);
 	}
@@ -162,6 +238,14 @@ static void sbi_tlb_sfence_vma_asid(struct sbi_tlb_info *tinfo)
 		return;
 	}
 
+	if (sbi_tlb_has_svinval()) {
+		__sbi_sfence_w_inval();
+		for (i = 0; i < size; i += PAGE_SIZE)
+			__sbi_sinval_vma_asid_va(start + i, asid);
+		__sbi_sfence_inval_ir();
+		return;
+	}
+
 	for (i = 0; i < size; i += PAGE_SIZE) {
 		__asm__ __volatile__("sfence.vma %0, %1"
 				     :
@@ -205,7 +289,7 @@ static void sbi_tlb_entry_process(struct sbi_tlb_info *tinfo)
 {
 	u32 rhartid;
 	struct sbi_scratch *rscratch = NULL;
-	unsigned long *rtlb_sync = NULL;
+	struct sbi_tlb_sync *rtlb_sync = NULL;
 
 	sbi_tlb_local_flush(tinfo);
 
@@ -215,7 +299,7 @@ static void sbi_tlb_entry_process(struct sbi_tlb_info *tinfo)
 			continue;
 
 		rtlb_sync = sbi_scratch_offset_ptr(rscratch, tlb_sync_off);
-		while (atomic_raw_xchg_ulong(rtlb_sync, 1)) ;
+		atomic_sub_return(&rtlb_sync->pending, 1);
 	}
 }
 
@@ -223,10 +307,10 @@ static void sbi_tlb_process_count(struct sbi_scratch *scratch, int count)
 {
 	struct sbi_tlb_info tinfo;
 	u32 deq_count = 0;
-	struct sbi_fifo *tlb_fifo =
+	struct sbi_mpsc_fifo *tlb_fifo =
 			sbi_scratch_offset_ptr(scratch, tlb_fifo_off);
 
-	while (!sbi_fifo_dequeue(tlb_fifo, &tinfo)) {
+	while (!sbi_mpsc_fifo_dequeue(tlb_fifo, &tinfo)) {
 		sbi_tlb_entry_process(&tinfo);
 		deq_count++;
 		if (deq_count > count)
@@ -238,64 +322,164 @@ static void sbi_tlb_process_count(struct sbi_scratch *scratch, int count)
 static void sbi_tlb_process(struct sbi_scratch *scratch)
 {
 	struct sbi_tlb_info tinfo;
-	struct sbi_fifo *tlb_fifo =
+	struct sbi_mpsc_fifo *tlb_fifo =
 			sbi_scratch_offset_ptr(scratch, tlb_fifo_off);
 
-	while (!sbi_fifo_dequeue(tlb_fifo, &tinfo))
+	while (!sbi_mpsc_fifo_dequeue(tlb_fifo, &tinfo))
 		sbi_tlb_entry_process(&tinfo);
 }
 
 static void sbi_tlb_sync(struct sbi_scratch *scratch)
 {
-	unsigned long *tlb_sync =
+	struct sbi_tlb_sync *tlb_sync =
 			sbi_scratch_offset_ptr(scratch, tlb_sync_off);
 
-	while (!atomic_raw_xchg_ulong(tlb_sync, 0)) {
+	while (atomic_read(&tlb_sync->pending) > 0) {
 		/*
-		 * While we are waiting for remote hart to set the sync,
-		 * consume fifo requests to avoid deadlock.
+		 * While we are waiting for remote harts to drop the pending
+		 * count, consume fifo requests to avoid deadlock.
 		 */
 		sbi_tlb_process_count(scratch, 1);
 	}
 
+	/* Nothing is pending so all asynchronous requests are complete */
+	tlb_sync->completed = tlb_sync->issued;
+
 	return;
 }
 
-static inline int __sbi_tlb_range_check(struct sbi_tlb_info *curr,
+/**
+ * Merge source hartmask of next entry into current entry
+ *
+ * Every source HART newly added to the current entry waits for one more
+ * acknowledgement. A source HART already present in the current entry
+ * (possible with asynchronous requests) will be acknowledged only once,
+ * so its pending count is dropped to match.
+ */
+static void sbi_tlb_merge_smask(struct sbi_tlb_info *curr,
+				struct sbi_tlb_info *next)
+{
+	u32 hartid;
+	struct sbi_scratch *scratch;
+	struct sbi_tlb_sync *tlb_sync;
+
+	sbi_hartmask_for_each_hart(hartid, &next->smask) {
+		if (!sbi_hartmask_test_hart(hartid, &curr->smask))
+			continue;
+
+		scratch = sbi_hartid_to_scratch(hartid);
+		if (!scratch)
+			continue;
+
+		tlb_sync = sbi_scratch_offset_ptr(scratch, tlb_sync_off);
+		atomic_sub_return(&tlb_sync->pending, 1);
+	}
+
+	sbi_hartmask_or(&curr->smask, &curr->smask, &next->smask);
+}
+
+/*
+ * Coverage of a flush request. A size of SBI_TLB_FLUSH_ALL flushes the
+ * whole address space of the given ASID/VMID whereas start == 0 and
+ * size == 0 flushes everything, so the latter is the widest.
+ */
+enum sbi_tlb_coverage {
+	SBI_TLB_COVER_RANGE,
+	SBI_TLB_COVER_SPACE,
+	SBI_TLB_COVER_ALL,
+};
+
+static inline int __sbi_tlb_coverage(struct sbi_tlb_info *tinfo)
+{
+	if (tinfo->start == 0 && tinfo->size == 0)
+		return SBI_TLB_COVER_ALL;
+	if (tinfo->size == SBI_TLB_FLUSH_ALL)
+		return SBI_TLB_COVER_SPACE;
+	return SBI_TLB_COVER_RANGE;
+}
+
+static inline bool __sbi_tlb_same_space(struct sbi_tlb_info *curr,
 					struct sbi_tlb_info *next)
 {
-	unsigned long curr_end;
-	unsigned long next_end;
-	int ret = SBI_FIFO_UNCHANGED;
+	if (curr->type != next->type)
+		return FALSE;
 
-	if (!curr || !next)
-		return ret;
+	switch (curr->type) {
+	case SBI_TLB_FLUSH_VMA_ASID:
+		return (curr->asid == next->asid) ? TRUE : FALSE;
+	case SBI_TLB_FLUSH_GVMA_VMID:
+	case SBI_TLB_FLUSH_VVMA:
+		return (curr->vmid == next->vmid) ? TRUE : FALSE;
+	case SBI_TLB_FLUSH_VVMA_ASID:
+		return (curr->asid == next->asid &&
+			curr->vmid == next->vmid) ? TRUE : FALSE;
+	default:
+		return TRUE;
+	}
+}
 
-	next_end = next->start + next->size;
-	curr_end = curr->start + curr->size;
-	if (next->start <= curr->start && next_end > curr_end) {
+static inline int __sbi_tlb_range_merge(struct sbi_tlb_info *curr,
+					struct sbi_tlb_info *next)
+{
+	unsigned long curr_end, next_end, start, end;
+	int curr_cov = __sbi_tlb_coverage(curr);
+	int next_cov = __sbi_tlb_coverage(next);
+
+	/* Wider (or equal) flush already queued */
+	if (next_cov <= curr_cov && next_cov != SBI_TLB_COVER_RANGE)
+		goto skip;
+	if (curr_cov != SBI_TLB_COVER_RANGE && next_cov == SBI_TLB_COVER_RANGE)
+		goto skip;
+
+	/* Next request is wider than the queued range */
+	if (next_cov != SBI_TLB_COVER_RANGE) {
 		curr->start = next->start;
 		curr->size  = next->size;
-		sbi_hartmask_or(&curr->smask, &curr->smask, &next->smask);
-		ret = SBI_FIFO_UPDATED;
-	} else if (next->start >= curr->start && next_end <= curr_end) {
-		sbi_hartmask_or(&curr->smask, &curr->smask, &next->smask);
-		ret = SBI_FIFO_SKIP;
+		goto update;
 	}
 
-	return ret;
+	next_end = next->start + next->size;
+	curr_end = curr->start + curr->size;
+
+	/* Neither overlapping nor adjacent */
+	if (next_end < curr->start || curr_end < next->start)
+		return SBI_FIFO_UNCHANGED;
+
+	if (curr->start <= next->start && next_end <= curr_end)
+		goto skip;
+
+	start = (curr->start < next->start) ? curr->start : next->start;
+	end = (curr_end < next_end) ? next_end : curr_end;
+	if ((end - start) > tlb_range_flush_limit) {
+		curr->start = 0;
+		curr->size  = SBI_TLB_FLUSH_ALL;
+	} else {
+		curr->start = start;
+		curr->size  = end - start;
+	}
+
+update:
+	sbi_tlb_merge_smask(curr, next);
+	return SBI_FIFO_UPDATED;
+
+skip:
+	sbi_tlb_merge_smask(curr, next);
+	return SBI_FIFO_SKIP;
 }
 
 /**
- * Call back to decide if an inplace fifo update is required or next entry can
- * can be skipped. Here are the different cases that are being handled.
+ * Call back to coalesce the next flush request with an already queued
+ * entry. Requests are only combined when they have the same type and
+ * target the same address space (ASID and/or VMID depending on type).
  *
  * Case1:
- *	if next flush request range lies within one of the existing entry, skip
- *	the next entry.
+ *	if the queued entry already covers the next request (including
+ *	repeated FENCE.I requests), skip the next entry.
  * Case2:
- *	if flush request range in current fifo entry lies within next flush
- *	request, update the current entry.
+ *	if the next request overlaps or is adjacent to the queued range,
+ *	or covers it, update the queued entry to the union of both. The
+ *	union is upgraded to a full address space flush once it grows
+ *	beyond tlb_range_flush_limit.
  *
  * Note:
  *	We can not issue a fifo reset anymore if a complete vma flush is requested.
@@ -308,24 +492,111 @@ static int sbi_tlb_update_cb(void *in, void *data)
 {
 	struct sbi_tlb_info *curr;
 	struct sbi_tlb_info *next;
-	int ret = SBI_FIFO_UNCHANGED;
 
 	if (!in || !data)
-		return ret;
+		return SBI_FIFO_UNCHANGED;
 
 	curr = (struct sbi_tlb_info *)data;
 	next = (struct sbi_tlb_info *)in;
 
-	if (next->type == SBI_TLB_FLUSH_VMA_ASID &&
-	    curr->type == SBI_TLB_FLUSH_VMA_ASID) {
-		if (next->asid == curr->asid)
-			ret = __sbi_tlb_range_check(curr, next);
-	} else if (next->type == SBI_TLB_FLUSH_VMA &&
-		   curr->type == SBI_TLB_FLUSH_VMA) {
-			ret = __sbi_tlb_range_check(curr, next);
+	if (!__sbi_tlb_same_space(curr, next))
+		return SBI_FIFO_UNCHANGED;
+
+	if (next->type == SBI_ITLB_FLUSH) {
+		sbi_tlb_merge_smask(curr, next);
+		return SBI_FIFO_SKIP;
+	}
+
+	return __sbi_tlb_range_merge(curr, next);
+}
+
+/*
+ * Measure the cost of a full sfence.vma and of a single page sfence.vma
+ * using MCYCLE and return the range size at which a full flush becomes
+ * cheaper than flushing page by page. Returns 0 when the cost of a page
+ * flush could not be measured.
+ *
+ * Note: M-mode runs without translation so this only measures the cost
+ * of executing the fences. The cost of refilling the translations thrown
+ * away by a full flush is not included, which is why calibration is
+ * only done for platforms which ask for it.
+ */
+static unsigned long sbi_tlb_calibrate_flush_limit(void)
+{
+	unsigned long i, start, full_cycles, page_cycles;
+	unsigned long va = (unsigned long)&tlb_range_flush_limit;
+
+	start = csr_read(CSR_MCYCLE);
+	for (i = 0; i < SBI_TLB_CALIBRATE_SAMPLES; i++)
+		sbi_tlb_flush_all();
+	full_cycles = csr_read(CSR_MCYCLE) - start;
+
+	start = csr_read(CSR_MCYCLE);
+	for (i = 0; i < SBI_TLB_CALIBRATE_SAMPLES; i++)
+		__asm__ __volatile__("sfence.vma %0"
+				     :
+				     : "r"(va + i * PAGE_SIZE)
+				     : "memory");
+	page_cycles = csr_read(CSR_MCYCLE) - start;
+
+	if (!page_cycles)
+		return 0;
+
+	return (full_cycles / page_cycles) * PAGE_SIZE;
+}
+
+/*
+ * Try to defer a request to an idle remote HART. An idle HART does not
+ * execute any lower privilege code so its stale translations can not be
+ * used until it wakes up, at which point it does a full local flush.
+ * Requests which need a particular VMID to be live in HGATP (VVMA types)
+ * can not be covered by a full flush and are never deferred.
+ */
+static bool sbi_tlb_defer_to_wake(struct sbi_scratch *remote_scratch,
+				  struct sbi_tlb_info *tinfo)
+{
+	long state;
+	struct sbi_tlb_sync *rtlb_sync =
+			sbi_scratch_offset_ptr(remote_scratch, tlb_sync_off);
+
+	if (tinfo->type == SBI_TLB_FLUSH_VVMA ||
+	    tinfo->type == SBI_TLB_FLUSH_VVMA_ASID)
+		return FALSE;
+
+	state = atomic_read(&rtlb_sync->idle);
+	while (state != SBI_TLB_AWAKE) {
+		if (state == SBI_TLB_IDLE_FLUSH_PENDING)
+			return TRUE;
+		if (atomic_cmpxchg(&rtlb_sync->idle, state,
+				   SBI_TLB_IDLE_FLUSH_PENDING) == state)
+			return TRUE;
+		state = atomic_read(&rtlb_sync->idle);
 	}
 
-	return ret;
+	return FALSE;
+}
+
+void sbi_tlb_idle_enter(struct sbi_scratch *scratch)
+{
+	struct sbi_tlb_sync *tlb_sync =
+			sbi_scratch_offset_ptr(scratch, tlb_sync_off);
+
+	atomic_xchg(&tlb_sync->idle, SBI_TLB_IDLE);
+}
+
+void sbi_tlb_idle_exit(struct sbi_scratch *scratch)
+{
+	struct sbi_tlb_sync *tlb_sync =
+			sbi_scratch_offset_ptr(scratch, tlb_sync_off);
+
+	if (atomic_xchg(&tlb_sync->idle, SBI_TLB_AWAKE) !=
+	    SBI_TLB_IDLE_FLUSH_PENDING)
+		return;
+
+	sbi_tlb_flush_all();
+	if (sbi_hart_has_extension(scratch, 'H'))
+		__sbi_hfence_gvma_all();
+	__asm__ __volatile("fence.i");
 }
 
 static int sbi_tlb_update(struct sbi_scratch *scratch,
@@ -333,9 +604,11 @@ static int sbi_tlb_update(struct sbi_scratch *scratch,
 			  u32 remote_hartid, void *data)
 {
 	int ret;
-	struct sbi_fifo *tlb_fifo_r;
+	struct sbi_mpsc_fifo *tlb_fifo_r;
 	struct sbi_tlb_info *tinfo = data;
 	u32 curr_hartid = current_hartid();
+	struct sbi_tlb_sync *tlb_sync =
+			sbi_scratch_offset_ptr(scratch, tlb_sync_off);
 
 	/*
 	 * If address range to flush is too big then simply
@@ -356,14 +629,28 @@ static int sbi_tlb_update(struct sbi_scratch *scratch,
 		return -1;
 	}
 
+	/* No need to interrupt an idle HART, it flushes on wake up */
+	if (sbi_tlb_defer_to_wake(remote_scratch, tinfo))
+		return SBI_EALREADY;
+
 	tlb_fifo_r = sbi_scratch_offset_ptr(remote_scratch, tlb_fifo_off);
 
-	ret = sbi_fifo_inplace_update(tlb_fifo_r, data, sbi_tlb_update_cb);
+	/*
+	 * Account the remote hart in our pending count before it can see
+	 * the request. The remote hart drops the count once for every
+	 * source hart in the processed entry's smask, so a single count
+	 * covers both the merged and the enqueued case.
+	 */
+	atomic_add_return(&tlb_sync->pending, 1);
+
+	ret = sbi_mpsc_fifo_inplace_update(tlb_fifo_r, data,
+					   sbi_tlb_update_cb);
 	if (ret != SBI_FIFO_UNCHANGED) {
+		tlb_sync->coalesced++;
 		return 1;
 	}
 
-	while (sbi_fifo_enqueue(tlb_fifo_r, data) < 0) {
+	while (sbi_mpsc_fifo_enqueue(tlb_fifo_r, data) < 0) {
 		/**
 		 * For now, Busy loop until there is space in the fifo.
 		 * There may be case where target hart is also
@@ -383,23 +670,127 @@ static int sbi_tlb_update(struct sbi_scratch *scratch,
 static struct sbi_ipi_event_ops tlb_ops = {
 	.name = "IPI_TLB",
 	.update = sbi_tlb_update,
-	.sync = sbi_tlb_sync,
+	.sync_all = sbi_tlb_sync,
 	.process = sbi_tlb_process,
 };
 
 static u32 tlb_event = SBI_IPI_EVENT_MAX;
 
+/*
+ * Asynchronous requests share the queue and process callback with
+ * tlb_ops but do not wait for remote HARTs after sending the IPIs.
+ */
+static struct sbi_ipi_event_ops tlb_async_ops = {
+	.name = "IPI_TLB_ASYNC",
+	.update = sbi_tlb_update,
+	.process = sbi_tlb_process,
+};
+
+static u32 tlb_async_event = SBI_IPI_EVENT_MAX;
+
 int sbi_tlb_request(ulong hmask, ulong hbase, struct sbi_tlb_info *tinfo)
 {
 	return sbi_ipi_send_many(hmask, hbase, tlb_event, tinfo);
 }
 
+int sbi_tlb_request_async(ulong hmask, ulong hbase,
+			  struct sbi_tlb_info *tinfo, ulong *ticket)
+{
+	int ret;
+	struct sbi_tlb_sync *tlb_sync =
+			sbi_scratch_thishart_offset_ptr(tlb_sync_off);
+
+	if (!ticket)
+		return SBI_EINVAL;
+
+	ret = sbi_ipi_send_many(hmask, hbase, tlb_async_event, tinfo);
+	if (ret)
+		return ret;
+
+	*ticket = ++tlb_sync->issued;
+
+	return 0;
+}
+
+/**
+ * Poll an asynchronous request ticket of current HART
+ * @param ticket the ticket returned by sbi_tlb_request_async()
+ * @return 1 if complete, 0 if possibly still pending and SBI_EINVAL for
+ * an unknown ticket
+ *
+ * Note: queued requests may be merged with each other on the remote HARTs,
+ * so acknowledgements are only counted per source HART, not per ticket.
+ * Completion is therefore only observed once nothing sent by this HART is
+ * outstanding. A HART which keeps issuing requests may see 0 for a ticket
+ * whose own flush is long done, so this is a conservative hint and
+ * sbi_tlb_ticket_wait() is required to guarantee completion.
+ */
+int sbi_tlb_ticket_status(ulong ticket)
+{
+	struct sbi_tlb_sync *tlb_sync =
+			sbi_scratch_thishart_offset_ptr(tlb_sync_off);
+
+	if (!ticket || tlb_sync->issued < ticket)
+		return SBI_EINVAL;
+
+	if (ticket <= tlb_sync->completed)
+		return 1;
+
+	if (atomic_read(&tlb_sync->pending) <= 0) {
+		tlb_sync->completed = tlb_sync->issued;
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * Wait for an asynchronous request ticket of current HART to complete
+ * @param ticket the ticket returned by sbi_tlb_request_async()
+ * @return 0 on success and SBI_EINVAL for an unknown ticket
+ *
+ * Note: this waits for every request sent by this HART so far, which
+ * always terminates because this HART can not issue new ones meanwhile.
+ */
+int sbi_tlb_ticket_wait(ulong ticket)
+{
+	int ret = sbi_tlb_ticket_status(ticket);
+
+	if (ret)
+		return (ret < 0) ? ret : 0;
+
+	sbi_tlb_sync(sbi_scratch_thishart_ptr());
+
+	return 0;
+}
+
+unsigned long sbi_tlb_coalesced_count(struct sbi_scratch *scratch)
+{
+	struct sbi_tlb_sync *tlb_sync;
+
+	if (!tlb_sync_off)
+		return 0;
+
+	tlb_sync = sbi_scratch_offset_ptr(scratch, tlb_sync_off);
+
+	return tlb_sync->coalesced;
+}
+
+unsigned long sbi_tlb_range_flush_limit(bool *calibrated)
+{
+	if (calibrated)
+		*calibrated = tlb_range_flush_calibrated;
+
+	return tlb_range_flush_limit;
+}
+
 int sbi_tlb_init(struct sbi_scratch *scratch, bool cold_boot)
 {
 	int ret;
 	void *tlb_mem;
-	unsigned long *tlb_sync;
-	struct sbi_fifo *tlb_q;
+	unsigned long limit;
+	struct sbi_tlb_sync *tlb_sync;
+	struct sbi_mpsc_fifo *tlb_q;
 	const struct sbi_platform *plat = sbi_platform_ptr(scratch);
 
 	if (cold_boot) {
@@ -414,7 +805,8 @@ int sbi_tlb_init(struct sbi_scratch *scratch, bool cold_boot)
 			return SBI_ENOMEM;
 		}
 		tlb_fifo_mem_off = sbi_scratch_alloc_offset(
-				SBI_TLB_FIFO_NUM_ENTRIES * SBI_TLB_INFO_SIZE,
+				SBI_TLB_FIFO_NUM_ENTRIES *
+				SBI_MPSC_FIFO_SLOT_SIZE(SBI_TLB_INFO_SIZE),
 				"IPI_TLB_FIFO_MEM");
 		if (!tlb_fifo_mem_off) {
 			sbi_scratch_free_offset(tlb_fifo_off);
@@ -429,13 +821,30 @@ int sbi_tlb_init(struct sbi_scratch *scratch, bool cold_boot)
 			return ret;
 		}
 		tlb_event = ret;
+		ret = sbi_ipi_event_create(&tlb_async_ops);
+		if (ret < 0) {
+			sbi_ipi_event_destroy(tlb_event);
+			sbi_scratch_free_offset(tlb_fifo_mem_off);
+			sbi_scratch_free_offset(tlb_fifo_off);
+			sbi_scratch_free_offset(tlb_sync_off);
+			return ret;
+		}
+		tlb_async_event = ret;
 		tlb_range_flush_limit = sbi_platform_tlbr_flush_limit(plat);
+		if (sbi_platform_has_tlb_flush_calibrate(plat)) {
+			limit = sbi_tlb_calibrate_flush_limit();
+			if (limit) {
+				tlb_range_flush_limit = limit;
+				tlb_range_flush_calibrated = TRUE;
+			}
+		}
 	} else {
 		if (!tlb_sync_off ||
 		    !tlb_fifo_off ||
 		    !tlb_fifo_mem_off)
 			return SBI_ENOMEM;
-		if (SBI_IPI_EVENT_MAX <= tlb_event)
+		if (SBI_IPI_EVENT_MAX <= tlb_event ||
+		    SBI_IPI_EVENT_MAX <= tlb_async_event)
 			return SBI_ENOSPC;
 	}
 
@@ -443,10 +852,12 @@ int sbi_tlb_init(struct sbi_scratch *scratch, bool cold_boot)
 	tlb_q = sbi_scratch_offset_ptr(scratch, tlb_fifo_off);
 	tlb_mem = sbi_scratch_offset_ptr(scratch, tlb_fifo_mem_off);
 
-	*tlb_sync = 0;
+	ATOMIC_INIT(&tlb_sync->pending, 0);
+	tlb_sync->issued = 0;
+	tlb_sync->completed = 0;
+	tlb_sync->coalesced = 0;
+	ATOMIC_INIT(&tlb_sync->idle, SBI_TLB_AWAKE);
 
-	sbi_fifo_init(tlb_q, tlb_mem,
-		      SBI_TLB_FIFO_NUM_ENTRIES, SBI_TLB_INFO_SIZE);
-
-	return 0;
+	return sbi_mpsc_fifo_init(tlb_q, tlb_mem,
+				  SBI_TLB_FIFO_NUM_ENTRIES, SBI_TLB_INFO_SIZE);
 }
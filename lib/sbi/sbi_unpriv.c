@@ -9,8 +9,10 @@
 
 #include <sbi/riscv_encoding.h>
 #include <sbi/sbi_bitops.h>
+#include <sbi/sbi_error.h>
 #include <sbi/sbi_hart.h>
 #include <sbi/sbi_scratch.h>
+#include <sbi/sbi_string.h>
 #include <sbi/sbi_trap.h>
 #include <sbi/sbi_unpriv.h>
 
@@ -114,6 +116,336 @@ void sbi_store_u64(u64 *addr, u64 val,
 }
 #endif
 
+/**
+ * Load up to SBI_UNPRIV_BLOCK_WORDS consecutive aligned ulong words using
+ * a single MPRV window. The words are kept in registers until the window
+ * is closed because M-mode stores would also be translated while MPRV is
+ * set. The remaining loads are skipped once a load traps. The trap handler
+ * clobbers A4 so it is cleared upfront and used to detect a trap.
+ *
+ * Returns the number of words loaded before the trap (if any).
+ */
+ulong sbi_load_ulong_words(const ulong *addr, ulong count, ulong *out,
+			   struct sbi_trap_info *trap)
+{
+	register ulong tinfo asm("a3");
+	register ulong ttmp asm("a4");
+	register ulong mstatus = 0;
+	register ulong mtvec = sbi_hart_expected_trap_addr();
+	ulong w0 = 0, w1 = 0, w2 = 0, w3 = 0, left = count;
+
+	trap->cause = 0;
+	if (!count || SBI_UNPRIV_BLOCK_WORDS < count)
+		return 0;
+
+	asm volatile(
+	    "add %[tinfo], %[taddr], zero\n"
+	    "add %[ttmp], zero, zero\n"
+	    "csrrw %[mtvec], " STR(CSR_MTVEC) ", %[mtvec]\n"
+	    "csrrs %[mstatus], " STR(CSR_MSTATUS) ", %[mprv]\n"
+	    ".option push\n"
+	    ".option norvc\n"
+	    REG_L " %[w0], 0(%[addr])\n"
+	    "bne %[ttmp], zero, 2f\n"
+	    "addi %[left], %[left], -1\n"
+	    "beq %[left], zero, 2f\n"
+	    REG_L " %[w1], " SZREG "(%[addr])\n"
+	    "bne %[ttmp], zero, 2f\n"
+	    "addi %[left], %[left], -1\n"
+	    "beq %[left], zero, 2f\n"
+	    "addi %[addr], %[addr], " SZREG "\n"
+	    REG_L " %[w2], " SZREG "(%[addr])\n"
+	    "bne %[ttmp], zero, 2f\n"
+	    "addi %[left], %[left], -1\n"
+	    "beq %[left], zero, 2f\n"
+	    "addi %[addr], %[addr], " SZREG "\n"
+	    REG_L " %[w3], " SZREG "(%[addr])\n"
+	    "bne %[ttmp], zero, 2f\n"
+	    "addi %[left], %[left], -1\n"
+	    ".option pop\n"
+	    "2: csrw " STR(CSR_MSTATUS) ", %[mstatus]\n"
+	    "csrw " STR(CSR_MTVEC) ", %[mtvec]"
+	    : [mstatus] "+&r"(mstatus), [mtvec] "+&r"(mtvec),
+	      [tinfo] "+&r"(tinfo), [ttmp] "+&r"(ttmp), [addr] "+&r"(addr),
+	      [left] "+&r"(left), [w0] "+&r"(w0), [w1] "+&r"(w1),
+	      [w2] "+&r"(w2), [w3] "+&r"(w3)
+	    : [mprv] "r"(MSTATUS_MPRV), [taddr] "r"((ulong)trap)
+	    : "memory");
+
+	out[0] = w0;
+	if (1 < count)
+		out[1] = w1;
+	if (2 < count)
+		out[2] = w2;
+	if (3 < count)
+		out[3] = w3;
+
+	return count - left;
+}
+
+/**
+ * Store up to SBI_UNPRIV_BLOCK_WORDS consecutive aligned ulong words using
+ * a single MPRV window. The remaining stores are skipped once a store traps.
+ *
+ * Returns the number of words stored before the trap (if any).
+ */
+ulong sbi_store_ulong_words(ulong *addr, ulong count, const ulong *in,
+			    struct sbi_trap_info *trap)
+{
+	register ulong tinfo asm("a3");
+	register ulong ttmp asm("a4");
+	register ulong mstatus = 0;
+	register ulong mtvec = sbi_hart_expected_trap_addr();
+	ulong w0, w1 = 0, w2 = 0, w3 = 0, left = count;
+
+	trap->cause = 0;
+	if (!count || SBI_UNPRIV_BLOCK_WORDS < count)
+		return 0;
+
+	w0 = in[0];
+	if (1 < count)
+		w1 = in[1];
+	if (2 < count)
+		w2 = in[2];
+	if (3 < count)
+		w3 = in[3];
+
+	asm volatile(
+	    "add %[tinfo], %[taddr], zero\n"
+	    "add %[ttmp], zero, zero\n"
+	    "csrrw %[mtvec], " STR(CSR_MTVEC) ", %[mtvec]\n"
+	    "csrrs %[mstatus], " STR(CSR_MSTATUS) ", %[mprv]\n"
+	    ".option push\n"
+	    ".option norvc\n"
+	    REG_S " %[w0], 0(%[addr])\n"
+	    "bne %[ttmp], zero, 2f\n"
+	    "addi %[left], %[left], -1\n"
+	    "beq %[left], zero, 2f\n"
+	    REG_S " %[w1], " SZREG "(%[addr])\n"
+	    "bne %[ttmp], zero, 2f\n"
+	    "addi %[left], %[left], -1\n"
+	    "beq %[left], zero, 2f\n"
+	    "addi %[addr], %[addr], " SZREG "\n"
+	    REG_S " %[w2], " SZREG "(%[addr])\n"
+	    "bne %[ttmp], zero, 2f\n"
+	    "addi %[left], %[left], -1\n"
+	    "beq %[left], zero, 2f\n"
+	    "addi %[addr], %[addr], " SZREG "\n"
+	    REG_S " %[w3], " SZREG "(%[addr])\n"
+	    "bne %[ttmp], zero, 2f\n"
+	    "addi %[left], %[left], -1\n"
+	    ".option pop\n"
+	    "2: csrw " STR(CSR_MSTATUS) ", %[mstatus]\n"
+	    "csrw " STR(CSR_MTVEC) ", %[mtvec]"
+	    : [mstatus] "+&r"(mstatus), [mtvec] "+&r"(mtvec),
+	      [tinfo] "+&r"(tinfo), [ttmp] "+&r"(ttmp), [addr] "+&r"(addr),
+	      [left] "+&r"(left)
+	    : [mprv] "r"(MSTATUS_MPRV), [taddr] "r"((ulong)trap),
+	      [w0] "r"(w0), [w1] "r"(w1), [w2] "r"(w2), [w3] "r"(w3)
+	    : "memory");
+
+	return count - left;
+}
+
+#define UNPRIV_WORD_MASK		(sizeof(ulong) - 1)
+
+static inline ulong unpriv_block_words(ulong len)
+{
+	ulong count = len / sizeof(ulong);
+
+	return (SBI_UNPRIV_BLOCK_WORDS < count) ?
+		SBI_UNPRIV_BLOCK_WORDS : count;
+}
+
+/**
+ * Copy len bytes from lower privilege address src to M-mode buffer dst.
+ * The unaligned head and tail are copied one byte at a time and the
+ * rest in blocks of aligned words. An aligned word never crosses a page
+ * so on a trap all bytes below trap->tval have been copied.
+ *
+ * Returns 0 on success and SBI_ETRAP on a trap.
+ */
+int sbi_copy_from_lower(void *dst, const void *src, ulong len,
+			struct sbi_trap_info *trap)
+{
+	ulong words[SBI_UNPRIV_BLOCK_WORDS], count, done;
+	ulong s = (ulong)src;
+	u8 *d = dst;
+
+	trap->cause = 0;
+
+	while (len && (s & UNPRIV_WORD_MASK)) {
+		*d = sbi_load_u8((const u8 *)s, trap);
+		if (trap->cause)
+			return SBI_ETRAP;
+		d++;
+		s++;
+		len--;
+	}
+
+	while (sizeof(ulong) <= len) {
+		count = unpriv_block_words(len);
+		done = sbi_load_ulong_words((const ulong *)s, count, words,
+					    trap);
+		sbi_memcpy(d, words, done * sizeof(ulong));
+		if (trap->cause)
+			return SBI_ETRAP;
+		d += done * sizeof(ulong);
+		s += done * sizeof(ulong);
+		len -= done * sizeof(ulong);
+	}
+
+	while (len) {
+		*d = sbi_load_u8((const u8 *)s, trap);
+		if (trap->cause)
+			return SBI_ETRAP;
+		d++;
+		s++;
+		len--;
+	}
+
+	return 0;
+}
+
+/**
+ * Copy len bytes from M-mode buffer src to lower privilege address dst.
+ * Same access pattern and trap reporting as sbi_copy_from_lower().
+ *
+ * Returns 0 on success and SBI_ETRAP on a trap.
+ */
+int sbi_copy_to_lower(void *dst, const void *src, ulong len,
+		      struct sbi_trap_info *trap)
+{
+	ulong words[SBI_UNPRIV_BLOCK_WORDS], count, done;
+	ulong d = (ulong)dst;
+	const u8 *s = src;
+
+	trap->cause = 0;
+
+	while (len && (d & UNPRIV_WORD_MASK)) {
+		sbi_store_u8((u8 *)d, *s, trap);
+		if (trap->cause)
+			return SBI_ETRAP;
+		d++;
+		s++;
+		len--;
+	}
+
+	while (sizeof(ulong) <= len) {
+		count = unpriv_block_words(len);
+		sbi_memcpy(words, s, count * sizeof(ulong));
+		done = sbi_store_ulong_words((ulong *)d, count, words, trap);
+		if (trap->cause)
+			return SBI_ETRAP;
+		d += done * sizeof(ulong);
+		s += done * sizeof(ulong);
+		len -= done * sizeof(ulong);
+	}
+
+	while (len) {
+		sbi_store_u8((u8 *)d, *s, trap);
+		if (trap->cause)
+			return SBI_ETRAP;
+		d++;
+		s++;
+		len--;
+	}
+
+	return 0;
+}
+
+/**
+ * Copy a NUL terminated string of at most len bytes (including the NUL)
+ * from lower privilege address src to M-mode buffer dst. Words past the
+ * NUL may be loaded but a trap on them is ignored once the NUL is found.
+ * Like strncpy(), dst is not terminated if no NUL is found in len bytes.
+ *
+ * Returns the string length, len if no NUL was found or SBI_ETRAP.
+ */
+long sbi_strncpy_from_lower(char *dst, const char *src, ulong len,
+			    struct sbi_trap_info *trap)
+{
+	ulong words[SBI_UNPRIV_BLOCK_WORDS], count, done, i, j;
+	ulong s = (ulong)src, copied = 0;
+	const char *w;
+
+	trap->cause = 0;
+
+	while (copied < len) {
+		if ((s & UNPRIV_WORD_MASK) ||
+		    (len - copied) < sizeof(ulong)) {
+			dst[copied] = sbi_load_u8((const u8 *)s, trap);
+			if (trap->cause)
+				return SBI_ETRAP;
+			if (!dst[copied])
+				return copied;
+			copied++;
+			s++;
+			continue;
+		}
+
+		count = unpriv_block_words(len - copied);
+		done = sbi_load_ulong_words((const ulong *)s, count, words,
+					    trap);
+		for (i = 0; i < done; i++) {
+			w = (const char *)&words[i];
+			for (j = 0; j < sizeof(ulong); j++) {
+				dst[copied] = w[j];
+				if (!w[j]) {
+					trap->cause = 0;
+					return copied;
+				}
+				copied++;
+			}
+		}
+		if (trap->cause)
+			return SBI_ETRAP;
+		s += done * sizeof(ulong);
+	}
+
+	return copied;
+}
+
+/**
+ * Store the low len bytes of val one byte at a time using a single MPRV
+ * window. The remaining stores are skipped once a store traps so the
+ * trap info describes the first byte which could not be written.
+ */
+void sbi_store_ulong_bytes(ulong addr, ulong val, ulong len,
+			   struct sbi_trap_info *trap)
+{
+	register ulong tinfo asm("a3");
+	register ulong ttmp asm("a4");
+	register ulong mstatus = 0;
+	register ulong mtvec = sbi_hart_expected_trap_addr();
+
+	trap->cause = 0;
+	if (!len)
+		return;
+
+	asm volatile(
+	    "add %[tinfo], %[taddr], zero\n"
+	    "add %[ttmp], zero, zero\n"
+	    "csrrw %[mtvec], " STR(CSR_MTVEC) ", %[mtvec]\n"
+	    "csrrs %[mstatus], " STR(CSR_MSTATUS) ", %[mprv]\n"
+	    ".option push\n"
+	    ".option norvc\n"
+	    "1: sb %[val], 0(%[addr])\n"
+	    "bne %[ttmp], zero, 2f\n"
+	    "srli %[val], %[val], 8\n"
+	    "addi %[addr], %[addr], 1\n"
+	    "addi %[len], %[len], -1\n"
+	    "bne %[len], zero, 1b\n"
+	    ".option pop\n"
+	    "2: csrw " STR(CSR_MSTATUS) ", %[mstatus]\n"
+	    "csrw " STR(CSR_MTVEC) ", %[mtvec]"
+	    : [mstatus] "+&r"(mstatus), [mtvec] "+&r"(mtvec),
+	      [tinfo] "+&r"(tinfo), [ttmp] "+&r"(ttmp),
+	      [addr] "+&r"(addr), [val] "+&r"(val), [len] "+&r"(len)
+	    : [mprv] "r"(MSTATUS_MPRV), [taddr] "r"((ulong)trap)
+	    : "memory");
+}
+
 ulong sbi_get_insn(ulong mepc, struct sbi_trap_info *trap)
 {
 	register ulong tinfo asm("a3");
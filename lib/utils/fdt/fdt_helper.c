@@ -14,6 +14,7 @@
 #include <sbi/sbi_scratch.h>
 #include <sbi_utils/fdt/fdt_helper.h>
 #include <sbi_utils/irqchip/plic.h>
+#include <sbi_utils/sys/aclint.h>
 #include <sbi_utils/sys/clint.h>
 
 #define DEFAULT_UART_FREQ		0
@@ -111,6 +112,12 @@ static int fdt_translate_address(void *fdt, uint64_t reg, int parent,
 
 int fdt_get_node_addr_size(void *fdt, int node, unsigned long *addr,
 			   unsigned long *size)
+{
+	return fdt_get_node_addr_size_index(fdt, node, 0, addr, size);
+}
+
+int fdt_get_node_addr_size_index(void *fdt, int node, int index,
+				 unsigned long *addr, unsigned long *size)
 {
 	int parent, len, i, rc;
 	int cell_addr, cell_size;
@@ -131,6 +138,10 @@ int fdt_get_node_addr_size(void *fdt, int node, unsigned long *addr,
 	prop_addr = fdt_getprop(fdt, node, "reg", &len);
 	if (!prop_addr)
 		return SBI_ENODEV;
+	if (index < 0 ||
+	    len < (int)((index + 1) * (cell_addr + cell_size) * sizeof(u32)))
+		return SBI_ENODEV;
+	prop_addr += index * (cell_addr + cell_size);
 	prop_size = prop_addr + cell_addr;
 
 	if (addr) {
@@ -381,22 +392,12 @@ int fdt_parse_plic(void *fdt, struct plic_data *plic, const char *compat)
 	return fdt_parse_plic_node(fdt, nodeoffset, plic);
 }
 
-int fdt_parse_clint_node(void *fdt, int nodeoffset, bool for_timer,
-			 struct clint_data *clint)
+static int fdt_parse_irq_harts(void *fdt, int nodeoffset, u32 match_hwirq,
+			       u32 *out_first_hartid, u32 *out_hart_count)
 {
 	const fdt32_t *val;
-	unsigned long reg_addr, reg_size;
 	int i, rc, count, cpu_offset, cpu_intc_offset;
-	u32 phandle, hwirq, hartid, first_hartid, last_hartid;
-	u32 match_hwirq = (for_timer) ? IRQ_M_TIMER : IRQ_M_SOFT;
-
-	if (nodeoffset < 0 || !clint || !fdt)
-		return SBI_ENODEV;
-
-	rc = fdt_get_node_addr_size(fdt, nodeoffset, &reg_addr, &reg_size);
-	if (rc < 0 || !reg_addr || !reg_size)
-		return SBI_ENODEV;
-	clint->addr = reg_addr;
+	u32 phandle, hwirq, hartid, first_hartid, last_hartid, hart_count;
 
 	val = fdt_getprop(fdt, nodeoffset, "interrupts-extended", &count);
 	if (!val || count < sizeof(fdt32_t))
@@ -405,7 +406,7 @@ int fdt_parse_clint_node(void *fdt, int nodeoffset, bool for_timer,
 
 	first_hartid = -1U;
 	last_hartid = 0;
-	clint->hart_count = 0;
+	hart_count = 0;
 	for (i = 0; i < count; i += 2) {
 		phandle = fdt32_to_cpu(val[i]);
 		hwirq = fdt32_to_cpu(val[i + 1]);
@@ -430,17 +431,41 @@ int fdt_parse_clint_node(void *fdt, int nodeoffset, bool for_timer,
 				first_hartid = hartid;
 			if (hartid > last_hartid)
 				last_hartid = hartid;
-			clint->hart_count++;
+			hart_count++;
 		}
 	}
 
 	if ((last_hartid < first_hartid) || first_hartid == -1U)
 		return SBI_ENODEV;
 
-	clint->first_hartid = first_hartid;
+	*out_first_hartid = first_hartid;
 	count = last_hartid - first_hartid + 1;
-	if (clint->hart_count < count)
-		clint->hart_count = count;
+	if (hart_count < count)
+		hart_count = count;
+	*out_hart_count = hart_count;
+
+	return 0;
+}
+
+int fdt_parse_clint_node(void *fdt, int nodeoffset, bool for_timer,
+			 struct clint_data *clint)
+{
+	unsigned long reg_addr, reg_size;
+	int rc;
+	u32 match_hwirq = (for_timer) ? IRQ_M_TIMER : IRQ_M_SOFT;
+
+	if (nodeoffset < 0 || !clint || !fdt)
+		return SBI_ENODEV;
+
+	rc = fdt_get_node_addr_size(fdt, nodeoffset, &reg_addr, &reg_size);
+	if (rc < 0 || !reg_addr || !reg_size)
+		return SBI_ENODEV;
+	clint->addr = reg_addr;
+
+	rc = fdt_parse_irq_harts(fdt, nodeoffset, match_hwirq,
+				 &clint->first_hartid, &clint->hart_count);
+	if (rc)
+		return rc;
 
 	/* TODO: We should figure-out CLINT has_64bit_mmio from DT node */
 	clint->has_64bit_mmio = TRUE;
@@ -448,6 +473,70 @@ int fdt_parse_clint_node(void *fdt, int nodeoffset, bool for_timer,
 	return 0;
 }
 
+int fdt_parse_aclint_mtimer_node(void *fdt, int nodeoffset,
+				 struct clint_data *mtimer)
+{
+	unsigned long addr[2], size[2];
+	int rc;
+
+	if (nodeoffset < 0 || !mtimer || !fdt)
+		return SBI_ENODEV;
+
+	rc = fdt_get_node_addr_size_index(fdt, nodeoffset, 0,
+					  &addr[0], &size[0]);
+	if (rc < 0 || !addr[0] || !size[0])
+		return SBI_ENODEV;
+
+	rc = fdt_get_node_addr_size_index(fdt, nodeoffset, 1,
+					  &addr[1], &size[1]);
+	if (!rc && addr[1] && size[1]) {
+		/* Separate regions, mtime is the small (8 bytes) one */
+		if (size[0] <= size[1]) {
+			mtimer->mtime_addr = addr[0];
+			mtimer->mtimecmp_addr = addr[1];
+		} else {
+			mtimer->mtime_addr = addr[1];
+			mtimer->mtimecmp_addr = addr[0];
+		}
+	} else {
+		/* Single region, mtimecmp first and mtime in last 8 bytes */
+		if (size[0] <= sizeof(u64))
+			return SBI_ENODEV;
+		mtimer->mtimecmp_addr = addr[0];
+		mtimer->mtime_addr = addr[0] + size[0] - sizeof(u64);
+	}
+	mtimer->addr = mtimer->mtimecmp_addr;
+	mtimer->is_aclint_mtimer = TRUE;
+
+	rc = fdt_parse_irq_harts(fdt, nodeoffset, IRQ_M_TIMER,
+				 &mtimer->first_hartid, &mtimer->hart_count);
+	if (rc)
+		return rc;
+
+	/* TODO: We should figure-out MTIMER has_64bit_mmio from DT node */
+	mtimer->has_64bit_mmio = TRUE;
+
+	return 0;
+}
+
+int fdt_parse_aclint_sswi_node(void *fdt, int nodeoffset,
+			       struct aclint_sswi_data *sswi)
+{
+	unsigned long reg_addr, reg_size;
+	int rc;
+
+	if (nodeoffset < 0 || !sswi || !fdt)
+		return SBI_ENODEV;
+
+	rc = fdt_get_node_addr_size(fdt, nodeoffset, &reg_addr, &reg_size);
+	if (rc < 0 || !reg_addr || !reg_size)
+		return SBI_ENODEV;
+	sswi->addr = reg_addr;
+
+	return fdt_parse_irq_harts(fdt, nodeoffset, IRQ_S_SOFT,
+				   &sswi->first_hartid, &sswi->hart_count);
+}
+
 int fdt_parse_compat_addr(void *fdt, unsigned long *addr,
 			  const char *compatible)
 {
@@ -7,16 +7,22 @@
  *   Anup Patel <anup.patel@wdc.com>
  */
 
+#include <sbi/sbi_error.h>
 #include <sbi/sbi_scratch.h>
 #include <sbi_utils/fdt/fdt_helper.h>
 #include <sbi_utils/ipi/fdt_ipi.h>
 
 extern struct fdt_ipi fdt_ipi_clint;
+extern struct fdt_ipi fdt_ipi_aclint_sswi;
 
 static struct fdt_ipi *ipi_drivers[] = {
 	&fdt_ipi_clint
 };
 
+static struct fdt_ipi *smode_ipi_drivers[] = {
+	&fdt_ipi_aclint_sswi
+};
+
 static void dummy_send(u32 target_hart)
 {
 }
@@ -31,21 +37,46 @@ static struct fdt_ipi dummy = {
 	.warm_init = NULL,
 	.exit = NULL,
 	.send = dummy_send,
+	.send_mask = NULL,
 	.clear = dummy_clear
 };
 
 static struct fdt_ipi *current_driver = &dummy;
+static struct fdt_ipi *smode_driver = NULL;
 
 void fdt_ipi_send(u32 target_hart)
 {
 	current_driver->send(target_hart);
 }
 
+void fdt_ipi_send_mask(ulong hmask, ulong hbase)
+{
+	ulong i;
+
+	if (current_driver->send_mask) {
+		current_driver->send_mask(hmask, hbase);
+		return;
+	}
+
+	for (i = hbase; hmask; i++, hmask >>= 1) {
+		if (hmask & 1UL)
+			current_driver->send(i);
+	}
+}
+
 void fdt_ipi_clear(u32 target_hart)
 {
 	current_driver->clear(target_hart);
 }
 
+int fdt_ipi_send_smode(u32 target_hart)
+{
+	if (!smode_driver || !smode_driver->send_smode)
+		return SBI_ENOTSUPP;
+
+	return smode_driver->send_smode(target_hart);
+}
+
 void fdt_ipi_exit(void)
 {
 	if (current_driver->exit)
@@ -59,15 +90,16 @@ static int fdt_ipi_warm_init(void)
 	return 0;
 }
 
-static int fdt_ipi_cold_init(void)
+static int fdt_ipi_probe(struct fdt_ipi **drivers, int count,
+			 struct fdt_ipi **out_driver)
 {
 	int pos, noff, rc;
 	struct fdt_ipi *drv;
 	const struct fdt_match *match;
 	void *fdt = sbi_scratch_thishart_arg1_ptr();
 
-	for (pos = 0; pos < array_size(ipi_drivers); pos++) {
-		drv = ipi_drivers[pos];
+	for (pos = 0; pos < count; pos++) {
+		drv = drivers[pos];
 
 		noff = -1;
 		while ((noff = fdt_find_match(fdt, noff,
@@ -77,16 +109,30 @@ static int fdt_ipi_cold_init(void)
 				if (rc)
 					return rc;
 			}
-			current_driver = drv;
+			*out_driver = drv;
 		}
 
-		if (current_driver != &dummy)
+		if (*out_driver == drv)
 			break;
 	}
 
 	return 0;
 }
 
+static int fdt_ipi_cold_init(void)
+{
+	int rc;
+
+	rc = fdt_ipi_probe(ipi_drivers, array_size(ipi_drivers),
+			   &current_driver);
+	if (rc)
+		return rc;
+
+	/* Supervisor software interrupt devices are optional */
+	return fdt_ipi_probe(smode_ipi_drivers, array_size(smode_ipi_drivers),
+			     &smode_driver);
+}
+
 int fdt_ipi_init(bool cold_boot)
 {
 	int rc;
@@ -0,0 +1,43 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <sbi/sbi_error.h>
+#include <sbi_utils/fdt/fdt_helper.h>
+#include <sbi_utils/ipi/fdt_ipi.h>
+#include <sbi_utils/sys/aclint.h>
+
+#define ACLINT_SSWI_MAX_NR			16
+
+static unsigned long aclint_sswi_count = 0;
+static struct aclint_sswi_data aclint_sswi[ACLINT_SSWI_MAX_NR];
+
+static int ipi_aclint_sswi_cold_init(void *fdt, int nodeoff,
+				     const struct fdt_match *match)
+{
+	int rc;
+	struct aclint_sswi_data *sswi;
+
+	if (ACLINT_SSWI_MAX_NR <= aclint_sswi_count)
+		return SBI_ENOSPC;
+	sswi = &aclint_sswi[aclint_sswi_count++];
+
+	rc = fdt_parse_aclint_sswi_node(fdt, nodeoff, sswi);
+	if (rc)
+		return rc;
+
+	return aclint_sswi_cold_init(sswi);
+}
+
+static const struct fdt_match ipi_aclint_sswi_match[] = {
+	{ .compatible = "riscv,aclint-sswi" },
+	{ },
+};
+
+struct fdt_ipi fdt_ipi_aclint_sswi = {
+	.match_table = ipi_aclint_sswi_match,
+	.cold_init = ipi_aclint_sswi_cold_init,
+	.warm_init = NULL,
+	.exit = NULL,
+	.send_smode = aclint_sswi_send,
+};
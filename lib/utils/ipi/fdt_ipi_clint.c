@@ -36,6 +36,7 @@ static int ipi_clint_cold_init(void *fdt, int nodeoff,
 
 static const struct fdt_match ipi_clint_match[] = {
 	{ .compatible = "riscv,clint0" },
+	{ .compatible = "riscv,aclint-mswi" },
 	{ },
 };
 
@@ -45,5 +46,6 @@ struct fdt_ipi fdt_ipi_clint = {
 	.warm_init = clint_warm_ipi_init,
 	.exit = NULL,
 	.send = clint_ipi_send,
+	.send_mask = clint_ipi_send_mask,
 	.clear = clint_ipi_clear,
 };
@@ -8,4 +8,5 @@
 #
 
 libsbiutils-objs-y += ipi/fdt_ipi.o
+libsbiutils-objs-y += ipi/fdt_ipi_aclint.o
 libsbiutils-objs-y += ipi/fdt_ipi_clint.o
@@ -0,0 +1,43 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <sbi/riscv_io.h>
+#include <sbi/sbi_error.h>
+#include <sbi/sbi_hartmask.h>
+#include <sbi_utils/sys/aclint.h>
+
+static struct aclint_sswi_data *aclint_sswi_hartid2data[SBI_HARTMASK_MAX_BITS];
+
+int aclint_sswi_send(u32 target_hart)
+{
+	struct aclint_sswi_data *sswi;
+
+	if (SBI_HARTMASK_MAX_BITS <= target_hart)
+		return SBI_EINVAL;
+	sswi = aclint_sswi_hartid2data[target_hart];
+	if (!sswi)
+		return SBI_ENOTSUPP;
+
+	/* Set supervisor software interrupt pending on target HART */
+	writel(1, &sswi->setssip[target_hart - sswi->first_hartid]);
+
+	return 0;
+}
+
+int aclint_sswi_cold_init(struct aclint_sswi_data *sswi)
+{
+	u32 i;
+
+	if (!sswi)
+		return SBI_EINVAL;
+
+	/* Initialize private data */
+	sswi->setssip = (void *)sswi->addr;
+
+	/* Update SSWI hartid table */
+	for (i = 0; i < sswi->hart_count; i++)
+		aclint_sswi_hartid2data[sswi->first_hartid + i] = sswi;
+
+	return 0;
+}
@@ -10,14 +10,20 @@
 #include <sbi/riscv_asm.h>
 #include <sbi/riscv_atomic.h>
 #include <sbi/riscv_io.h>
+#include <sbi/sbi_console.h>
 #include <sbi/sbi_error.h>
 #include <sbi/sbi_hartmask.h>
+#include <sbi/sbi_scratch.h>
+#include <sbi/sbi_timer.h>
 #include <sbi_utils/sys/clint.h>
 
 #define CLINT_IPI_OFF		0
 #define CLINT_TIME_CMP_OFF	0x4000
 #define CLINT_TIME_VAL_OFF	0xbff8
 
+#define CLINT_TIME_DELTA_SAMPLES	16
+#define CLINT_TIME_DELTA_RECAL_TICKS	(1ULL << 24)
+
 static struct clint_data *clint_ipi_hartid2data[SBI_HARTMASK_MAX_BITS];
 
 void clint_ipi_send(u32 target_hart)
@@ -34,6 +40,28 @@ void clint_ipi_send(u32 target_hart)
 	writel(1, &clint->ipi[target_hart - clint->first_hartid]);
 }
 
+void clint_ipi_send_mask(ulong hmask, ulong hbase)
+{
+	ulong i;
+	struct clint_data *clint;
+
+	/* Order prior memory writes once for all doorbells */
+	wmb();
+
+	for (i = hbase; hmask; i++, hmask >>= 1) {
+		if (!(hmask & 1UL))
+			continue;
+		if (SBI_HARTMASK_MAX_BITS <= i)
+			break;
+		clint = clint_ipi_hartid2data[i];
+		if (!clint)
+			continue;
+
+		/* Set CLINT IPI */
+		writel_relaxed(1, &clint->ipi[i - clint->first_hartid]);
+	}
+}
+
 void clint_ipi_clear(u32 target_hart)
 {
 	struct clint_data *clint;
@@ -135,16 +163,76 @@ void clint_timer_event_start(u64 next_event)
 		       &clint->time_cmp[target_hart - clint->first_hartid]);
 }
 
+/*
+ * Estimate the time delta against the reference CLINT from several
+ * samples. Each sample reads the reference between two local reads so
+ * the sample with the smallest round trip has the least MMIO jitter.
+ * Half of that round trip bounds the error of the estimate.
+ */
+static u64 clint_time_delta_sample(struct clint_data *clint, u64 *error)
+{
+	int i;
+	u64 v1, v2, mv, rtt, best_rtt = -1ULL, delta = 0;
+	struct clint_data *reference = clint->time_delta_reference;
+
+	for (i = 0; i < CLINT_TIME_DELTA_SAMPLES; i++) {
+		v1 = clint->time_rd(clint->time_val);
+		mv = reference->time_rd(reference->time_val);
+		v2 = clint->time_rd(clint->time_val);
+		rtt = v2 - v1;
+		if (rtt < best_rtt) {
+			best_rtt = rtt;
+			delta = mv - (v1 + rtt / 2);
+		}
+	}
+
+	*error = best_rtt / 2 + 1;
+	return delta;
+}
+
+#if __riscv_xlen != 32
+/*
+ * Time read through this CLINT must never go backwards, so time_delta is
+ * only ever increased. If this CLINT runs fast compared to the reference
+ * then its time stays ahead by the accumulated drift.
+ *
+ * Comparators already programmed with the old time_delta are not rebased,
+ * so pending timer events of other HARTs fire late by the increase.
+ *
+ * Note: the event lives in the timer queue of the HART which calibrated
+ * time_delta. Once that HART goes through sbi_timer_exit() (e.g. HSM stop)
+ * the event is dropped and re-calibration stops for this CLINT.
+ */
+static void clint_time_delta_recalibrate(struct sbi_timer_event *ev)
+{
+	u64 delta, error;
+	struct clint_data *clint =
+		container_of(ev, struct clint_data, time_delta_event);
+
+	/* Only follow real drift and not the sampling noise */
+	delta = clint_time_delta_sample(clint, &error);
+	if ((s64)(delta - clint->time_delta) >
+	    (s64)(error + clint->time_delta_error)) {
+		clint->time_delta = delta;
+		clint->time_delta_error = error;
+	}
+
+	sbi_timer_event_add(ev, ev->deadline + CLINT_TIME_DELTA_RECAL_TICKS);
+}
+#endif
+
 int clint_warm_timer_init(void)
 {
-	u64 v1, v2, mv;
 	u32 target_hart = current_hartid();
-	struct clint_data *reference;
 	struct clint_data *clint = clint_timer_hartid2data[target_hart];
 
 	if (!clint)
 		return SBI_ENODEV;
 
+	/* Clear CLINT Time Compare */
+	clint->time_wr(-1ULL,
+		       &clint->time_cmp[target_hart - clint->first_hartid]);
+
 	/*
 	 * Compute delta if reference available
 	 *
@@ -153,19 +241,39 @@ int clint_warm_timer_init(void)
 	 * atomic flag timer_delta_computed to ensure that only one HART does
 	 * time_delta computation.
 	 */
-	if (clint->time_delta_reference) {
-		reference = clint->time_delta_reference;
-		if (!atomic_raw_xchg_ulong(&clint->time_delta_computed, 1)) {
-			v1 = clint->time_rd(clint->time_val);
-			mv = reference->time_rd(reference->time_val);
-			v2 = clint->time_rd(clint->time_val);
-			clint->time_delta = mv - ((v1 / 2) + (v2 / 2));
+	if (clint->time_delta_reference &&
+	    !atomic_raw_xchg_ulong(&clint->time_delta_computed, 1)) {
+		clint->time_delta = clint_time_delta_sample(clint,
+						&clint->time_delta_error);
+		sbi_dprintf("clint@%#lx: time_delta %lld (error %llu ticks)\n",
+			    clint->addr, (long long)clint->time_delta,
+			    (unsigned long long)clint->time_delta_error);
+
+		/*
+		 * Periodic re-calibration from the M-mode timer interrupt
+		 * of this HART. A 64bit time_delta can't be updated
+		 * atomically for other HARTs on RV32 so it is RV64 only.
+		 */
+#if __riscv_xlen != 32
+		if (sbi_scratch_thishart_ptr()->options &
+		    SBI_SCRATCH_TIME_DELTA_RECALIBRATE) {
+			clint->time_delta_event.callback =
+					clint_time_delta_recalibrate;
+			sbi_timer_event_add(&clint->time_delta_event,
+					    clint_timer_value() +
+					    CLINT_TIME_DELTA_RECAL_TICKS);
 		}
+#endif
 	}
 
-	/* Clear CLINT Time Compare */
-	clint->time_wr(-1ULL,
-		       &clint->time_cmp[target_hart - clint->first_hartid]);
+	/*
+	 * Let trap entry read CLINT Time Value directly for emulated
+	 * TIME CSR reads. On RV64, this needs 64bit MMIO access.
+	 */
+#if __riscv_xlen != 32
+	if (clint->has_64bit_mmio)
+#endif
+		sbi_timer_set_fast_read(clint->time_val, &clint->time_delta);
 
 	return 0;
 }
@@ -182,8 +290,17 @@ int clint_cold_timer_init(struct clint_data *clint,
 	clint->time_delta_reference = reference;
 	clint->time_delta_computed = 0;
 	clint->time_delta = 0;
-	clint->time_val = (u64 *)((void *)clint->addr + CLINT_TIME_VAL_OFF);
-	clint->time_cmp = (u64 *)((void *)clint->addr + CLINT_TIME_CMP_OFF);
+	if (clint->is_aclint_mtimer) {
+		if (!clint->mtime_addr || !clint->mtimecmp_addr)
+			return SBI_EINVAL;
+		clint->time_val = (u64 *)clint->mtime_addr;
+		clint->time_cmp = (u64 *)clint->mtimecmp_addr;
+	} else {
+		clint->time_val = (u64 *)((void *)clint->addr +
+					  CLINT_TIME_VAL_OFF);
+		clint->time_cmp = (u64 *)((void *)clint->addr +
+					  CLINT_TIME_CMP_OFF);
+	}
 	clint->time_rd = clint_time_rd32;
 	clint->time_wr = clint_time_wr32;
 
@@ -29,7 +29,10 @@ static int timer_clint_cold_init(void *fdt, int nodeoff,
 	if (1 < clint_timer_count)
 		ctmaster = &clint_timer[0];
 
-	rc = fdt_parse_clint_node(fdt, nodeoff, TRUE, ct);
+	if (match->data)
+		rc = fdt_parse_aclint_mtimer_node(fdt, nodeoff, ct);
+	else
+		rc = fdt_parse_clint_node(fdt, nodeoff, TRUE, ct);
 	if (rc)
 		return rc;
 
@@ -38,6 +41,7 @@ static int timer_clint_cold_init(void *fdt, int nodeoff,
 
 static const struct fdt_match timer_clint_match[] = {
 	{ .compatible = "riscv,clint0" },
+	{ .compatible = "riscv,aclint-mtimer", .data = (void *)TRUE },
 	{ },
 };
 
@@ -185,6 +185,7 @@ const struct sbi_platform_operations platform_ops = {
 	.irqchip_init = openpiton_irqchip_init,
 	.ipi_init = openpiton_ipi_init,
 	.ipi_send = clint_ipi_send,
+	.ipi_send_mask = clint_ipi_send_mask,
 	.ipi_clear = clint_ipi_clear,
 	.timer_init = openpiton_timer_init,
 	.timer_value = clint_timer_value,
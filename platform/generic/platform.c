@@ -220,7 +220,9 @@ const struct sbi_platform_operations platform_ops = {
 	.irqchip_init		= fdt_irqchip_init,
 	.irqchip_exit		= fdt_irqchip_exit,
 	.ipi_send		= fdt_ipi_send,
+	.ipi_send_mask		= fdt_ipi_send_mask,
 	.ipi_clear		= fdt_ipi_clear,
+	.ipi_send_smode		= fdt_ipi_send_smode,
 	.ipi_init		= fdt_ipi_init,
 	.ipi_exit		= fdt_ipi_exit,
 	.get_tlbr_flush_limit	= generic_tlbr_flush_limit,
@@ -207,6 +207,7 @@ const struct sbi_platform_operations platform_ops = {
 	.console_init		= ux600_console_init,
 	.irqchip_init		= ux600_irqchip_init,
 	.ipi_send		= clint_ipi_send,
+	.ipi_send_mask		= clint_ipi_send_mask,
 	.ipi_clear		= clint_ipi_clear,
 	.ipi_init		= ux600_ipi_init,
 	.timer_value		= clint_timer_value,
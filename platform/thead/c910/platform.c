@@ -134,6 +134,7 @@ const struct sbi_platform_operations platform_ops = {
 
 	.ipi_init            = c910_ipi_init,
 	.ipi_send            = clint_ipi_send,
+	.ipi_send_mask       = clint_ipi_send_mask,
 	.ipi_clear           = clint_ipi_clear,
 
 	.timer_init          = c910_timer_init,